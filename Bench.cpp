@@ -0,0 +1,168 @@
+//
+//  Bench.cpp
+//  CloudSim
+//
+//  Decision-cost benchmark for the scheduling policies. Replays a synthetic
+//  arrival and completion sequence from MockSimulator into the scheduler
+//  interface and reports the latency of every callback at p50/p99, and the
+//  heap allocations per call:
+//
+//      bench [-s scheduler] [-m machines,machines,...] [-t tasks] [-r seed]
+//
+//  Every cluster size runs in its own process so that the scheduler and the
+//  view caches start clean. A run that throws, or that stalls before every
+//  task has completed, is reported instead of its latencies and makes bench
+//  exit with 1.
+//
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <sstream>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "Interfaces.h"
+#include "MockSimulator.hpp"
+
+using namespace std::chrono;
+
+static uint64_t Allocations = 0;
+
+void * operator new(size_t size) {
+    Allocations++;
+    void * p = malloc(size == 0 ? 1 : size);
+    if (p == nullptr) {
+        throw bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void * p) noexcept {
+    free(p);
+}
+
+void operator delete(void * p, size_t size) noexcept {
+    free(p);
+}
+
+typedef struct {
+    const char * name;
+    vector<uint64_t> nanoseconds;
+    uint64_t allocations;
+} Callback_t;
+
+static Callback_t Callbacks[] = {
+    {"HandleNewTask", {}, 0},
+    {"HandleTaskCompletion", {}, 0},
+    {"SchedulerCheck", {}, 0},
+    {"StateChangeComplete", {}, 0},
+    {"MigrationDone", {}, 0},
+};
+
+static void Dispatch(const MockEvent_t & event) {
+    switch (event.type) {
+        case MOCK_NEW_TASK:         HandleNewTask(event.time, event.id); break;
+        case MOCK_TASK_COMPLETION:  HandleTaskCompletion(event.time, event.id); break;
+        case MOCK_SCHEDULER_CHECK:  SchedulerCheck(event.time); break;
+        case MOCK_STATE_CHANGE:     StateChangeComplete(event.time, event.id); break;
+        case MOCK_MIGRATION_DONE:   MigrationDone(event.time, event.id); break;
+    }
+}
+
+static uint64_t Percentile(vector<uint64_t> & samples, double p) {
+    size_t n = size_t(p * (samples.size() - 1));
+    nth_element(samples.begin(), samples.begin() + n, samples.end());
+    return samples[n];
+}
+
+// Returns false if the run stalled with tasks left
+static bool Run(unsigned machines, unsigned tasks, uint64_t seed) {
+    Mock_Build(machines, tasks, seed);
+    InitScheduler();
+
+    MockEvent_t event;
+    while (Mock_NextEvent(event)) {
+        Callback_t & callback = Callbacks[event.type];
+        uint64_t allocations = Allocations;
+        steady_clock::time_point start = steady_clock::now();
+        Dispatch(event);
+        callback.nanoseconds.push_back(duration_cast<nanoseconds>(steady_clock::now() - start).count());
+        callback.allocations += Allocations - allocations;
+    }
+    if (Mock_CompletedTasks() < tasks) {
+        fprintf(stderr, "%u machines: stalled with %u of %u tasks completed\n", machines, Mock_CompletedTasks(), tasks);
+        return false;
+    }
+
+    for (Callback_t & callback : Callbacks) {
+        size_t calls = callback.nanoseconds.size();
+        if (calls == 0) {
+            continue;
+        }
+        printf("%9u  %-21s %9zu %11llu %11llu %12.2f\n", machines, callback.name, calls,
+               (unsigned long long) Percentile(callback.nanoseconds, 0.5),
+               (unsigned long long) Percentile(callback.nanoseconds, 0.99),
+               double(callback.allocations) / calls);
+    }
+    printf("%9u  SLA0 %.2f%%  SLA1 %.2f%%  SLA2 %.2f%%\n", machines, GetSLAReport(SLA0), GetSLAReport(SLA1), GetSLAReport(SLA2));
+    return true;
+}
+
+int main(int argc, char * argv[]) {
+    vector<unsigned> sizes = {100, 1000, 10000, 100000};
+    unsigned tasks = 10000;
+    uint64_t seed = 1;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "s:m:t:r:")) != -1) {
+        switch (opt) {
+            case 's':
+                setenv("SIM_SCHEDULER", optarg, 1);
+                break;
+            case 'm': {
+                sizes.clear();
+                stringstream list(optarg);
+                string size;
+                while (getline(list, size, ',')) {
+                    sizes.push_back(atoi(size.c_str()));
+                }
+                break;
+            }
+            case 't':
+                tasks = atoi(optarg);
+                break;
+            case 'r':
+                seed = strtoull(optarg, nullptr, 10);
+                break;
+            default:
+                fprintf(stderr, "Usage: %s [-s scheduler] [-m machines,machines,...] [-t tasks] [-r seed]\n", argv[0]);
+                return 1;
+        }
+    }
+
+    printf("%9s  %-21s %9s %11s %11s %12s\n", "machines", "callback", "calls", "p50_ns", "p99_ns", "allocs/call");
+    fflush(stdout);
+    int failed = 0;
+    for (unsigned machines : sizes) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            bool completed = false;
+            try {
+                completed = Run(machines, tasks, seed);
+            } catch (const exception & e) {
+                fprintf(stderr, "%u machines: %s\n", machines, e.what());
+            }
+            fflush(stdout);
+            _exit(completed ? 0 : 1);
+        }
+        int status = 0;
+        if (pid < 0 || waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+            if (pid > 0 && WIFSIGNALED(status)) {
+                fprintf(stderr, "%u machines: killed by signal %d\n", machines, WTERMSIG(status));
+            }
+            failed = 1;
+        }
+    }
+    return failed;
+}
@@ -0,0 +1,99 @@
+//
+//  CapacityIndex.cpp
+//  CloudSim
+//
+
+#include "CapacityIndex.hpp"
+
+#include <algorithm>
+
+#include "Interfaces.h"
+
+static const double NO_MIPS = -1.0;
+
+void CapacityIndex::Init(const vector<MachineId_t> & machine_ids, const vector<bool> & machine_gpus) {
+    machines = machine_ids;
+    gpus = machine_gpus;
+    present.assign(machines.size(), false);
+
+    MachineId_t max_id = 0;
+    for (MachineId_t id : machines) {
+        max_id = max(max_id, id);
+    }
+    slots.assign(machines.empty() ? 0 : max_id + 1, -1);
+    for (unsigned i = 0; i < machines.size(); i++) {
+        slots[machines[i]] = i;
+    }
+
+    leaves = 1;
+    while (leaves < machines.size()) {
+        leaves *= 2;
+    }
+    tree.assign(2 * leaves, {NO_MIPS, 0, NO_MIPS, 0});
+}
+
+bool CapacityIndex::Contains(MachineId_t machine_id) const {
+    if (machine_id >= slots.size() || slots[machine_id] < 0) {
+        return false;
+    }
+    return present[slots[machine_id]];
+}
+
+int CapacityIndex::FirstFit(double mips, unsigned memory, bool need_gpu, unsigned from) const {
+    if (from >= machines.size()) {
+        return -1;
+    }
+    return Search(1, 0, leaves - 1, from, mips, memory, need_gpu);
+}
+
+void CapacityIndex::Remove(MachineId_t machine_id) {
+    if (machine_id >= slots.size() || slots[machine_id] < 0) {
+        return;
+    }
+    unsigned slot = slots[machine_id];
+    present[slot] = false;
+    SetLeaf(slot, NO_MIPS, 0);
+}
+
+void CapacityIndex::Update(MachineId_t machine_id, double headroom, unsigned free_memory) {
+    if (machine_id >= slots.size() || slots[machine_id] < 0) {
+        ThrowException("CapacityIndex::Update(): Machine is not part of the index ", machine_id);
+    }
+    unsigned slot = slots[machine_id];
+    present[slot] = true;
+    // Keep eligible machines distinguishable from empty leaves even if overcommitted
+    SetLeaf(slot, max(headroom, 0.0), free_memory);
+}
+
+int CapacityIndex::Search(unsigned node, unsigned lo, unsigned hi, unsigned from, double mips, unsigned memory, bool need_gpu) const {
+    if (hi < from) {
+        return -1;
+    }
+    const Node & n = tree[node];
+    if (need_gpu ? (n.gpu_mips < mips || n.gpu_memory <= memory) : (n.mips < mips || n.memory <= memory)) {
+        return -1;
+    }
+    if (lo == hi) {
+        return lo;
+    }
+    unsigned mid = (lo + hi) / 2;
+    int slot = Search(2 * node, lo, mid, from, mips, memory, need_gpu);
+    if (slot >= 0) {
+        return slot;
+    }
+    return Search(2 * node + 1, mid + 1, hi, from, mips, memory, need_gpu);
+}
+
+void CapacityIndex::SetLeaf(unsigned slot, double headroom, unsigned free_memory) {
+    unsigned node = leaves + slot;
+    tree[node] = {headroom, free_memory, NO_MIPS, 0};
+    if (gpus[slot]) {
+        tree[node].gpu_mips = headroom;
+        tree[node].gpu_memory = free_memory;
+    }
+    for (node /= 2; node > 0; node /= 2) {
+        const Node & l = tree[2 * node];
+        const Node & r = tree[2 * node + 1];
+        tree[node] = {max(l.mips, r.mips), max(l.memory, r.memory), max(l.gpu_mips, r.gpu_mips), max(l.gpu_memory, r.gpu_memory)};
+    }
+}
@@ -0,0 +1,48 @@
+//
+//  CapacityIndex.hpp
+//  CloudSim
+//
+//  Segment tree over the machines of one CPU type, keyed on the MIPS headroom
+//  and free memory of each machine. Only machines that have been Update()d are
+//  eligible; Remove() takes a machine out of the index.
+//
+
+#ifndef CapacityIndex_hpp
+#define CapacityIndex_hpp
+
+#include <vector>
+
+#include "SimTypes.h"
+
+class CapacityIndex {
+public:
+    CapacityIndex()             {}
+    void Init(const vector<MachineId_t> & machines, const vector<bool> & gpus);
+    bool Contains(MachineId_t machine_id) const;
+    // Returns the slot of the first eligible machine at or after slot "from" with
+    // headroom >= mips and free memory > memory, or -1 if there is none
+    int FirstFit(double mips, unsigned memory, bool need_gpu, unsigned from = 0) const;
+    MachineId_t MachineAt(unsigned slot) const      { return machines[slot]; }
+    void Remove(MachineId_t machine_id);
+    unsigned Size() const                           { return machines.size(); }
+    void Update(MachineId_t machine_id, double headroom, unsigned free_memory);
+private:
+    struct Node {
+        double mips;                // Max headroom over eligible leaves, -1 if none
+        unsigned memory;            // Max free memory over eligible leaves
+        double gpu_mips;            // Same, restricted to machines with GPUs
+        unsigned gpu_memory;
+    };
+
+    int Search(unsigned node, unsigned lo, unsigned hi, unsigned from, double mips, unsigned memory, bool need_gpu) const;
+    void SetLeaf(unsigned slot, double headroom, unsigned free_memory);
+
+    vector<MachineId_t> machines;   // slot -> machine
+    vector<int> slots;              // machine -> slot, -1 if the machine is of another CPU type
+    vector<bool> gpus;              // slot -> has GPU
+    vector<bool> present;           // slot -> eligible
+    vector<Node> tree;
+    unsigned leaves = 0;
+};
+
+#endif /* CapacityIndex_hpp */
@@ -0,0 +1,29 @@
+//
+//  DemandForecast.cpp
+//  CloudSim
+//
+
+#include "DemandForecast.hpp"
+
+#include <algorithm>
+
+double DemandForecast::Forecast(Time_t horizon) const {
+    return max(0.0, level + trend * horizon);
+}
+
+void DemandForecast::Observe(Time_t now, double demand) {
+    if (!primed) {
+        level = demand;
+        last = now;
+        primed = true;
+        return;
+    }
+    if (now <= last) {
+        return;
+    }
+    double elapsed = now - last;
+    double previous = level;
+    level = alpha * demand + (1 - alpha) * (level + trend * elapsed);
+    trend = beta * (level - previous) / elapsed + (1 - beta) * trend;
+    last = now;
+}
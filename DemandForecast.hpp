@@ -0,0 +1,32 @@
+//
+//  DemandForecast.hpp
+//  CloudSim
+//
+//  Holt's linear exponential smoothing over a sampled demand series: a
+//  smoothed level plus a smoothed trend per microsecond. Forecast(h) projects
+//  the demand h microseconds after the last sample, never below zero. alpha
+//  weighs new samples into the level, beta new slopes into the trend.
+//
+
+#ifndef DemandForecast_hpp
+#define DemandForecast_hpp
+
+#include "SimTypes.h"
+
+class DemandForecast {
+public:
+    DemandForecast()                            {}
+    DemandForecast(double alpha, double beta)   : alpha(alpha), beta(beta) {}
+    double Forecast(Time_t horizon) const;
+    double Level() const                        { return level; }
+    void Observe(Time_t now, double demand);
+private:
+    double alpha = 0.5;
+    double beta = 0.3;
+    double level = 0.0;
+    double trend = 0.0;
+    Time_t last = 0;
+    bool primed = false;
+};
+
+#endif /* DemandForecast_hpp */
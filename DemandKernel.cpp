@@ -0,0 +1,24 @@
+//
+//  DemandKernel.cpp
+//  CloudSim
+//
+
+#include "DemandKernel.h"
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+void Demand_Utilization(const double * demand, const double * capacity, size_t count, double * utilization) {
+    size_t i = 0;
+#ifdef __AVX2__
+    for (; i + 4 <= count; i += 4) {
+        __m256d mips = _mm256_loadu_pd(demand + i);
+        __m256d max_mips = _mm256_loadu_pd(capacity + i);
+        _mm256_storeu_pd(utilization + i, _mm256_div_pd(mips, max_mips));
+    }
+#endif
+    for (; i < count; i++) {
+        utilization[i] = demand[i] / capacity[i];
+    }
+}
@@ -0,0 +1,27 @@
+//
+//  DemandKernel.h
+//  CloudSim
+//
+//  Batch kernels for cluster-wide sweeps over booked demand. The caller gathers
+//  the per-machine figures into contiguous arrays and gets all results in one
+//  pass. Built with AVX2 (make AVX2=1) the loops run four machines at a time;
+//  otherwise a scalar loop computes the same values.
+//
+//  pMapper's TaskComplete() ranks every machine by utilization and is the one
+//  caller. The PeriodicCheck() sweeps of the other policies do not divide per
+//  machine: they add up the booked demand and the P0 capacity of a cpu type
+//  and take one ratio, then add woken machines to the capacity one at a time.
+//  Gathering the figures into arrays first would only add a pass. The queue
+//  walks of Greedy and pMapper stop at the first machine that fits, and Greedy
+//  keeps the utilization of its active machines keyed in LoadOrder already.
+//
+
+#ifndef DemandKernel_h
+#define DemandKernel_h
+
+#include <cstddef>
+
+// utilization[i] = demand[i] / capacity[i], both in mips
+extern void Demand_Utilization(const double * demand, const double * capacity, size_t count, double * utilization);
+
+#endif /* DemandKernel_h */
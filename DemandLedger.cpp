@@ -0,0 +1,140 @@
+//
+//  DemandLedger.cpp
+//  CloudSim
+//
+
+#include "DemandLedger.hpp"
+
+#include <cmath>
+
+#include "Interfaces.h"
+
+void DemandLedger::AddTask(TaskId_t task_id, VMId_t vm_id, MachineId_t machine_id, Time_t now) {
+    if (tasks.count(task_id)) {
+        ThrowException("DemandLedger::AddTask(): Task is already booked ", task_id);
+    }
+    auto it = vms.find(vm_id);
+    if (it == vms.end()) {
+        it = vms.insert({vm_id, {{0.0, 0}, machine_id}}).first;
+    }
+    double mips = Demand(task_id, now);
+    tasks[task_id] = {mips, vm_id};
+    Book(it->second.demand, mips);
+    Book(machines[it->second.machine_id], mips);
+}
+
+void DemandLedger::Book(Entry & entry, double mips) {
+    entry.mips += mips;
+    entry.tasks++;
+}
+
+// Recomputes the sums the way the policies did before the ledger, walking the
+// tasks of every VM and reading each one's info from the simulator
+void DemandLedger::Check(Time_t now) const {
+    if (!tasks.empty() && booked_at != now) {
+        ThrowException("DemandLedger::Check(): Demand was not rebooked at ", now);
+    }
+    vector<Entry> expected(machines.size(), {0.0, 0});
+
+    for (auto & [vm_id, vm] : vms) {
+        double vm_mips = 0.0;
+        vector<TaskId_t> active_tasks = VM_GetInfo(vm_id).active_tasks;
+        for (TaskId_t task_id : active_tasks) {
+            auto it = tasks.find(task_id);
+            if (it == tasks.end() || it->second.vm_id != vm_id) {
+                ThrowException("DemandLedger::Check(): Task is not booked on its VM ", task_id);
+            }
+            TaskInfo_t info = GetTaskInfo(task_id);
+            vm_mips += task_demand(info.remaining_instructions, info.total_instructions, info.target_completion, now);
+        }
+        if (active_tasks.size() != vm.demand.tasks || fabs(vm_mips - vm.demand.mips) > 1e-6 * max(1.0, fabs(vm_mips))) {
+            ThrowException("DemandLedger::Check(): VM demand is out of sync ", vm_id);
+        }
+        expected[vm.machine_id].mips += vm_mips;
+        expected[vm.machine_id].tasks += vm.demand.tasks;
+    }
+
+    for (MachineId_t i = 0; i < machines.size(); i++) {
+        if (expected[i].tasks != machines[i].tasks || fabs(expected[i].mips - machines[i].mips) > 1e-6 * max(1.0, fabs(expected[i].mips))) {
+            ThrowException("DemandLedger::Check(): Machine demand is out of sync ", i);
+        }
+    }
+}
+
+double DemandLedger::Demand(TaskId_t task_id, Time_t now) const {
+    return task_demand(GetTaskRemainingInstructions(task_id), GetTaskTotalInstructions(task_id), GetTaskTargetCompletion(task_id), now);
+}
+
+void DemandLedger::Init(unsigned total_machines, TaskDemand_t demand) {
+    task_demand = demand;
+    booked_at = 0;
+    machines.assign(total_machines, {0.0, 0});
+    tasks.clear();
+    vms.clear();
+}
+
+void DemandLedger::MoveVM(VMId_t vm_id, MachineId_t machine_id) {
+    auto it = vms.find(vm_id);
+    // A VM without booked tasks has nothing to carry over
+    if (it == vms.end() || it->second.machine_id == machine_id) {
+        return;
+    }
+    VMEntry & vm = it->second;
+    Entry & from = machines[vm.machine_id];
+    from.tasks -= vm.demand.tasks;
+    from.mips = from.tasks == 0 ? 0.0 : from.mips - vm.demand.mips;
+    machines[machine_id].tasks += vm.demand.tasks;
+    machines[machine_id].mips += vm.demand.mips;
+    vm.machine_id = machine_id;
+}
+
+void DemandLedger::Rebook(Time_t now) {
+    booked_at = now;
+    for (Entry & machine : machines) {
+        machine.mips = 0.0;
+    }
+    for (auto & [vm_id, vm] : vms) {
+        vm.demand.mips = 0.0;
+    }
+    for (auto & [task_id, task] : tasks) {
+        task.mips = Demand(task_id, now);
+        VMEntry & vm = vms[task.vm_id];
+        vm.demand.mips += task.mips;
+        machines[vm.machine_id].mips += task.mips;
+    }
+}
+
+void DemandLedger::Release(Entry & entry, double mips) {
+    entry.tasks--;
+    // Snap back to zero so that add/remove rounding does not accumulate
+    entry.mips = entry.tasks == 0 ? 0.0 : entry.mips - mips;
+}
+
+void DemandLedger::RemoveTask(TaskId_t task_id) {
+    auto it = tasks.find(task_id);
+    if (it == tasks.end()) {
+        return;
+    }
+    VMEntry & vm = vms[it->second.vm_id];
+    Release(vm.demand, it->second.mips);
+    Release(machines[vm.machine_id], it->second.mips);
+    if (vm.demand.tasks == 0) {
+        vms.erase(it->second.vm_id);
+    }
+    tasks.erase(it);
+}
+
+double DemandLedger::TaskDemand(TaskId_t task_id) const {
+    auto it = tasks.find(task_id);
+    return it == tasks.end() ? 0.0 : it->second.mips;
+}
+
+double DemandLedger::VMDemand(VMId_t vm_id) const {
+    auto it = vms.find(vm_id);
+    return it == vms.end() ? 0.0 : it->second.demand.mips;
+}
+
+MachineId_t DemandLedger::VMMachine(VMId_t vm_id) const {
+    auto it = vms.find(vm_id);
+    return it == vms.end() ? MachineId_t(-1) : it->second.machine_id;
+}
@@ -0,0 +1,66 @@
+//
+//  DemandLedger.hpp
+//  CloudSim
+//
+//  Booked MIPS demand per task, VM and machine. The demand of a task is the
+//  rate it needs to finish by its target, given by the policy's TaskDemand_t.
+//  That rate moves with the clock and the progress of the task, so Rebook()
+//  recomputes every task at the current time. Between rebooks reading the
+//  demand of a VM or a machine is O(1). Build with -DDEBUG to make Check()
+//  compare a freshly rebooked ledger against a walk over the tasks of every VM
+//  that reads their info from the simulator.
+//
+
+#ifndef DemandLedger_hpp
+#define DemandLedger_hpp
+
+#include <unordered_map>
+#include <vector>
+
+#include "SimTypes.h"
+
+// MIPS a task needs from now on to finish by its target completion
+typedef double (*TaskDemand_t)(uint64_t remaining_instr, uint64_t total_instr, Time_t target, Time_t now);
+
+class DemandLedger {
+public:
+    DemandLedger()              {}
+    void AddTask(TaskId_t task_id, VMId_t vm_id, MachineId_t machine_id, Time_t now);
+    void Check(Time_t now) const;
+    void Init(unsigned total_machines, TaskDemand_t demand);
+    double MachineDemand(MachineId_t machine_id) const      { return machines[machine_id].mips; }
+    unsigned MachineTasks(MachineId_t machine_id) const     { return machines[machine_id].tasks; }
+    void MoveVM(VMId_t vm_id, MachineId_t machine_id);
+    // Recomputes the demand of every task at now
+    void Rebook(Time_t now);
+    void RemoveTask(TaskId_t task_id);
+    double TaskDemand(TaskId_t task_id) const;
+    double VMDemand(VMId_t vm_id) const;
+    // Machine the demand of the VM is booked on, MachineId_t(-1) if it has none
+    MachineId_t VMMachine(VMId_t vm_id) const;
+private:
+    struct Entry {
+        double mips;
+        unsigned tasks;
+    };
+    struct TaskEntry {
+        double mips;
+        VMId_t vm_id;
+    };
+    struct VMEntry {
+        Entry demand;
+        MachineId_t machine_id;
+    };
+
+    void Book(Entry & entry, double mips);
+    double Demand(TaskId_t task_id, Time_t now) const;
+    void Release(Entry & entry, double mips);
+
+    TaskDemand_t task_demand = nullptr;
+    Time_t booked_at = 0;
+    vector<Entry> machines;
+    unordered_map<TaskId_t, TaskEntry> tasks;
+    unordered_map<VMId_t, VMEntry> vms;
+};
+
+#endif /* DemandLedger_hpp */
@@ -31,6 +31,8 @@ extern CPUType_t        Machine_GetCPUType(MachineId_t machine_id);
 extern uint64_t         Machine_GetEnergy(MachineId_t machine_id);
 extern double           Machine_GetClusterEnergy();
 extern MachineInfo_t    Machine_GetInfo(MachineId_t machine_id);
+extern const MachineSpec_t & Machine_GetSpec(MachineId_t machine_id);   // Never changes after Machine_Add, no copy
+extern MachineStatus_t  Machine_GetStatus(MachineId_t machine_id);      // Dynamic state only, no vectors
 extern unsigned         Machine_GetTotal();
 extern void             Machine_SetCorePerformance(MachineId_t machine_id, unsigned core_id, CPUPerformance_t p_state);  // This is oriented toward dynamic energy
 extern void             Machine_SetState(MachineId_t machine_id, MachineState_t s_state);
@@ -57,6 +59,10 @@ extern unsigned         GetNumTasks();
 extern TaskInfo_t       GetTaskInfo(TaskId_t task_id);
 extern unsigned         GetTaskMemory(TaskId_t task_id);
 extern unsigned         GetTaskPriority(TaskId_t task_id);
+extern uint64_t         GetTaskRemainingInstructions(TaskId_t task_id);
+extern TaskRequirements_t GetTaskRequirements(TaskId_t task_id);
+extern Time_t           GetTaskTargetCompletion(TaskId_t task_id);
+extern uint64_t         GetTaskTotalInstructions(TaskId_t task_id);
 extern bool             IsSLAViolated(TaskId_t task_id);
 extern bool             IsTaskCompleted(TaskId_t task_id);
 extern bool             IsTaskGPUCapable(TaskId_t task_id);
@@ -70,6 +76,8 @@ extern void             VM_Attach(VMId_t vm_id, MachineId_t machine_id);
 extern void             VM_AddTask(VMId_t vm_id, TaskId_t task_id, Priority_t priority);
 extern VMId_t           VM_Create(VMType_t vm_type, CPUType_t cpu);
 extern VMInfo_t         VM_GetInfo(VMId_t vm_id);
+extern TaskList_t       VM_GetTasks(VMId_t vm_id);                          // Active tasks, copied per call, valid until the next call for the vm
+extern VMType_t         VM_GetType(VMId_t vm_id);
 extern void             VM_Migrate(VMId_t vm_id, MachineId_t machine_id);
 extern void             VM_RemoveTask(VMId_t vm_id, TaskId_t task_id);
 extern void             VM_Shutdown(VMId_t vm_id);
@@ -50,10 +50,12 @@ extern void CompleteTask(TaskId_t task_id);
 extern unsigned GetActiveTasks();
 extern uint64_t GetRemainingInstructions(TaskId_t task_id);
 extern void SetRemainingInstructions(TaskId_t task_id, uint64_t instructions);
+extern void TaskView_Reset();                  // Drops the fields copied out by the task getters
 
 // Internal VM Interface
 extern bool VM_IsPendingMigration(VMId_t vm_id);
 extern void VM_MigrationCompleted(VMId_t vm_id);
 extern void VM_MigrationStarted(VMId_t vm_id);
+extern void VMView_Reset();                    // Drops the task lists and types kept by VM_GetTasks() and VM_GetType()
 
 #endif /* Internal_Interfaces_h */
@@ -0,0 +1,38 @@
+//
+//  LoadOrder.cpp
+//  CloudSim
+//
+
+#include "LoadOrder.hpp"
+
+#include <algorithm>
+
+bool LoadOrder::Contains(MachineId_t machine_id) const {
+    return machine_id < present.size() && present[machine_id];
+}
+
+void LoadOrder::Remove(MachineId_t machine_id) {
+    if (!Contains(machine_id)) {
+        return;
+    }
+    order.erase(find(order.begin(), order.end(), machine_id));
+    present[machine_id] = false;
+}
+
+void LoadOrder::Sort() {
+    sort(order.begin(), order.end(), [this](MachineId_t a, MachineId_t b) {
+        return loads[a] < loads[b];
+    });
+}
+
+void LoadOrder::Update(MachineId_t machine_id, double load) {
+    if (machine_id >= present.size()) {
+        present.resize(machine_id + 1, false);
+        loads.resize(machine_id + 1, 0.0);
+    }
+    loads[machine_id] = load;
+    if (!present[machine_id]) {
+        present[machine_id] = true;
+        order.push_back(machine_id);
+    }
+}
@@ -0,0 +1,42 @@
+//
+//  LoadOrder.hpp
+//  CloudSim
+//
+//  Machines ordered by load, least loaded first. The load of a machine is
+//  whatever the caller last passed to Update(), so the caller re-keys a machine
+//  whenever its load changes, and Sort() compares the stored loads instead of
+//  recomputing the load of both sides of every comparison. Update() does not
+//  move the machine, a new one is appended. Sort() is a plain std::sort over
+//  the order the previous Sort() left, so machines with equal load end up where
+//  the policy's first-fit walks always found them. Do not Remove() while
+//  iterating.
+//
+
+#ifndef LoadOrder_hpp
+#define LoadOrder_hpp
+
+#include <vector>
+
+#include "SimTypes.h"
+
+class LoadOrder {
+public:
+    typedef vector<MachineId_t>::const_iterator const_iterator;
+
+    LoadOrder()                 {}
+    const_iterator begin() const                        { return order.begin(); }
+    bool Contains(MachineId_t machine_id) const;
+    const_iterator end() const                          { return order.end(); }
+    double Load(MachineId_t machine_id) const           { return loads[machine_id]; }
+    void Remove(MachineId_t machine_id);
+    size_t size() const                                 { return order.size(); }
+    void Sort();
+    // Appends the machine if it is not in the order yet
+    void Update(MachineId_t machine_id, double load);
+private:
+    vector<MachineId_t> order;
+    vector<double> loads;
+    vector<bool> present;
+};
+
+#endif /* LoadOrder_hpp */
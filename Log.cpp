@@ -0,0 +1,104 @@
+//
+//  Log.cpp
+//  CloudSim
+//
+
+#include "Log.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <sstream>
+
+#include "Interfaces.h"
+
+static const unsigned LOG_MAX_ARGS = 8;
+
+typedef struct {
+    unsigned level;
+    unsigned count;
+    LogArg_t args[LOG_MAX_ARGS];
+} LogRecord_t;
+
+static int log_level = -1;                  // -1 until probed
+static vector<LogRecord_t> ring;
+static size_t ring_next = 0;
+static bool ring_full = false;
+
+// main keeps the -v level to itself. SimOutput() prints a line exactly when the
+// message level is at most that level, so probe it once with cout pointed at a
+// scratch buffer: print an empty message at levels 0, 1, ... and stop at the
+// first level that leaves the buffer as it was. Levels below it are enabled,
+// so the -v level is the one before.
+static void Probe() {
+    ostringstream scratch;
+    streambuf * out = cout.rdbuf(scratch.rdbuf());
+    unsigned level = 0;
+    for (; level <= SIM_LOG_MAX_LEVEL; level++) {
+        size_t printed_bytes = scratch.str().size();
+        SimOutput("", level);
+        if (scratch.str().size() == printed_bytes) {
+            break;
+        }
+    }
+    cout.rdbuf(out);
+    log_level = int(level) - 1;
+
+    const char * entries = getenv("SIM_LOG_RING");
+    if (entries != nullptr && atoi(entries) > 0) {
+        ring.resize(atoi(entries));
+    }
+}
+
+static string Format(const LogArg_t * args, unsigned count) {
+    ostringstream msg;
+    for (unsigned i = 0; i < count; i++) {
+        switch (args[i].kind) {
+            case LogArg_t::STRING:      msg << args[i].s; break;
+            case LogArg_t::UNSIGNED:    msg << args[i].u; break;
+            case LogArg_t::SIGNED:      msg << args[i].i; break;
+            case LogArg_t::REAL:        msg << args[i].d; break;
+        }
+    }
+    return msg.str();
+}
+
+bool Log_Enabled(unsigned level) {
+    if (log_level < 0) {
+        Probe();
+    }
+    return int(level) <= log_level;
+}
+
+void Log_Flush() {
+    size_t count = ring_full ? ring.size() : ring_next;
+    size_t first = ring_full ? ring_next : 0;
+    for (size_t i = 0; i < count; i++) {
+        const LogRecord_t & record = ring[(first + i) % ring.size()];
+        SimOutput(Format(record.args, record.count), record.level);
+    }
+    ring_next = 0;
+    ring_full = false;
+}
+
+void Log_Reset() {
+    log_level = -1;
+    ring.clear();
+    ring_next = 0;
+    ring_full = false;
+}
+
+void Log_Write(unsigned level, initializer_list<LogArg_t> args) {
+    if (ring.empty()) {
+        SimOutput(Format(args.begin(), args.size()), level);
+        return;
+    }
+    if (args.size() > LOG_MAX_ARGS) {
+        ThrowException("Log_Write(): Too many arguments for the ring buffer ", args.size());
+    }
+    LogRecord_t & record = ring[ring_next];
+    record.level = level;
+    record.count = args.size();
+    copy(args.begin(), args.end(), record.args);
+    ring_next = (ring_next + 1) % ring.size();
+    ring_full = ring_full || ring_next == 0;
+}
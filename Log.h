@@ -0,0 +1,60 @@
+//
+//  Log.h
+//  CloudSim
+//
+//  Leveled logging front end for SimOutput(). SIM_LOG() checks the level before
+//  any argument is formatted, so a disabled message costs one comparison:
+//
+//      SIM_LOG(4, "HandleNewTask(): Received new task ", task_id, " at time ", time);
+//
+//  Arguments are string literals, integers or doubles. Levels above
+//  SIM_LOG_MAX_LEVEL are compiled out; build with -DSIM_LOG_MAX_LEVEL=0 to
+//  strip everything but level 0. At run time a message is emitted when its
+//  level is at most the -v level the simulator was started with.
+//
+//  Setting SIM_LOG_RING=<entries> in the environment keeps the last <entries>
+//  messages unformatted in a ring buffer instead of printing them; Log_Flush()
+//  formats and prints them after the run.
+//
+
+#ifndef Log_h
+#define Log_h
+
+#include <initializer_list>
+
+#include "SimTypes.h"
+
+#ifndef SIM_LOG_MAX_LEVEL
+#define SIM_LOG_MAX_LEVEL 4
+#endif
+
+#define SIM_LOG(level, ...)                                                 \
+    do {                                                                    \
+        if ((level) <= SIM_LOG_MAX_LEVEL && Log_Enabled(level)) {           \
+            Log_Write((level), {__VA_ARGS__});                              \
+        }                                                                   \
+    } while (0)
+
+struct LogArg_t {
+    enum { STRING, UNSIGNED, SIGNED, REAL } kind;
+    union {
+        const char * s;
+        uint64_t u;
+        int64_t i;
+        double d;
+    };
+
+    LogArg_t()                          : kind(UNSIGNED), u(0) {}
+    LogArg_t(const char * value)        : kind(STRING), s(value) {}
+    LogArg_t(int value)                 : kind(SIGNED), i(value) {}
+    LogArg_t(unsigned value)            : kind(UNSIGNED), u(value) {}
+    LogArg_t(uint64_t value)            : kind(UNSIGNED), u(value) {}
+    LogArg_t(double value)              : kind(REAL), d(value) {}
+};
+
+extern bool             Log_Enabled(unsigned level);
+extern void             Log_Flush();                                    // Prints and empties the ring buffer
+extern void             Log_Reset();                                    // Drops the ring buffer, probes the level again
+extern void             Log_Write(unsigned level, initializer_list<LogArg_t> args);
+
+#endif /* Log_h */
@@ -0,0 +1,33 @@
+//
+//  MachinePool.cpp
+//  CloudSim
+//
+
+#include "MachinePool.hpp"
+
+void MachinePool::Add(MachineId_t machine_id) {
+    if (machine_id >= positions.size()) {
+        positions.resize(machine_id + 1, -1);
+    }
+    if (positions[machine_id] >= 0) {
+        return;
+    }
+    positions[machine_id] = members.size();
+    members.push_back(machine_id);
+}
+
+bool MachinePool::Contains(MachineId_t machine_id) const {
+    return machine_id < positions.size() && positions[machine_id] >= 0;
+}
+
+void MachinePool::Remove(MachineId_t machine_id) {
+    if (!Contains(machine_id)) {
+        return;
+    }
+    unsigned position = positions[machine_id];
+    MachineId_t last = members.back();
+    members[position] = last;
+    positions[last] = position;
+    members.pop_back();
+    positions[machine_id] = -1;
+}
@@ -0,0 +1,33 @@
+//
+//  MachinePool.hpp
+//  CloudSim
+//
+//  Set of machines kept as a dense array plus a machine -> position map, so
+//  that adding, removing and testing a machine are O(1) and iterating visits
+//  only the members. Remove() moves the last member into the freed position,
+//  so the iteration order is not the insertion order.
+//
+
+#ifndef MachinePool_hpp
+#define MachinePool_hpp
+
+#include <vector>
+
+#include "SimTypes.h"
+
+class MachinePool {
+public:
+    MachinePool()               {}
+    void Add(MachineId_t machine_id);
+    const MachineId_t * begin() const                   { return members.data(); }
+    bool Contains(MachineId_t machine_id) const;
+    const MachineId_t * end() const                     { return members.data() + members.size(); }
+    void Remove(MachineId_t machine_id);
+    size_t size() const                                 { return members.size(); }
+    MachineId_t operator[](size_t i) const              { return members[i]; }
+private:
+    vector<MachineId_t> members;
+    vector<int> positions;      // machine -> index in members, -1 if not a member
+};
+
+#endif /* MachinePool_hpp */
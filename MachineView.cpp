@@ -0,0 +1,34 @@
+//
+//  MachineView.cpp
+//  CloudSim
+//
+//  Machine_GetSpec() and Machine_GetStatus() on top of Machine_GetInfo(). The
+//  spec of a machine never changes after Machine_Add, so it is copied out once
+//  and handed back by reference from then on. The status is the scalar part of
+//  MachineInfo_t; it still goes through Machine_GetInfo() until the machine
+//  module can return it directly.
+//
+
+#include "Interfaces.h"
+
+static vector<MachineSpec_t> Specs;
+
+const MachineSpec_t & Machine_GetSpec(MachineId_t machine_id) {
+    if (machine_id >= Specs.size()) {
+        unsigned total = Machine_GetTotal();
+        if (machine_id >= total) {
+            ThrowException("Machine_GetSpec(): Invalid machine id ", machine_id);
+        }
+        for (MachineId_t id = Specs.size(); id < total; id++) {
+            MachineInfo_t info = Machine_GetInfo(id);
+            Specs.push_back({info.num_cpus, info.cpu, info.memory_size, info.gpus,
+                             info.performance, info.c_states, info.p_states, info.s_states, info.machine_id});
+        }
+    }
+    return Specs[machine_id];
+}
+
+MachineStatus_t Machine_GetStatus(MachineId_t machine_id) {
+    MachineInfo_t info = Machine_GetInfo(machine_id);
+    return {info.memory_used, info.active_tasks, info.active_vms, info.energy_consumed, info.s_state, info.p_state};
+}
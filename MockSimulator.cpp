@@ -0,0 +1,394 @@
+//
+//  MockSimulator.cpp
+//  CloudSim
+//
+
+#include "MockSimulator.hpp"
+
+#include <algorithm>
+#include <queue>
+
+#include "Interfaces.h"
+#include "Internal_Interfaces.h"
+
+static const Time_t CHECK_PERIOD = 100000;          // SchedulerCheck() every 100 ms
+static const Time_t STATE_CHANGE_DELAY = 10000;
+static const Time_t MIGRATION_DELAY = 50000;
+static const Time_t STALL_LIMIT = 600000000;        // Give up 10 minutes after the last arrival
+
+typedef struct {
+    MachineSpec_t spec;
+    MachineStatus_t status;
+} MockMachine_t;
+
+typedef struct {
+    TaskInfo_t info;
+    double rate;                    // Instructions per microsecond while placed
+    VMId_t vm_id;                   // VMId_t(-1) while not placed
+    Time_t started;                 // Start of the current placement
+    unsigned placement;             // Tells stale completion events apart
+} MockTask_t;
+
+typedef struct {
+    VMInfo_t info;
+    bool attached;
+} MockVM_t;
+
+typedef struct {
+    MockEvent_t event;
+    uint64_t order;                 // FIFO among events at the same time
+    unsigned placement;
+} QueuedEvent_t;
+
+struct LaterEvent {
+    bool operator()(const QueuedEvent_t & a, const QueuedEvent_t & b) const {
+        return a.event.time > b.event.time || (a.event.time == b.event.time && a.order > b.order);
+    }
+};
+
+static vector<MockMachine_t> Machines;
+static vector<MockTask_t> Tasks;
+static vector<MockVM_t> VMs;
+static priority_queue<QueuedEvent_t, vector<QueuedEvent_t>, LaterEvent> Events;
+static uint64_t Order = 0;
+static Time_t Clock = 0;
+static Time_t LastArrival = 0;
+static unsigned Completed = 0;
+static unsigned SLACompleted[NUM_SLAS];
+static unsigned SLAMissed[NUM_SLAS];
+
+// splitmix64, so that a seed gives the same workload everywhere
+static uint64_t Random(uint64_t & state) {
+    uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+static void Push(Time_t time, MockEventType_t type, unsigned id, unsigned placement = 0) {
+    Events.push({{time, type, id}, Order++, placement});
+}
+
+static MockMachine_t & GetMachine(MachineId_t machine_id) {
+    if (machine_id >= Machines.size()) {
+        ThrowException("Mock: Invalid machine id ", machine_id);
+    }
+    return Machines[machine_id];
+}
+
+static MockTask_t & GetTask(TaskId_t task_id) {
+    if (task_id >= Tasks.size()) {
+        ThrowException("Mock: Invalid task id ", task_id);
+    }
+    return Tasks[task_id];
+}
+
+static MockVM_t & GetVM(VMId_t vm_id) {
+    if (vm_id >= VMs.size()) {
+        ThrowException("Mock: Invalid VM id ", vm_id);
+    }
+    return VMs[vm_id];
+}
+
+// Takes a placed task off its machine, keeping the instructions it has executed
+static void Unplace(MockTask_t & task) {
+    MockVM_t & vm = VMs[task.vm_id];
+    vector<TaskId_t> & tasks = vm.info.active_tasks;
+    tasks.erase(find(tasks.begin(), tasks.end(), task.info.task_id));
+    if (vm.attached) {
+        MockMachine_t & machine = Machines[vm.info.machine_id];
+        machine.status.memory_used -= task.info.required_memory;
+        machine.status.active_tasks--;
+    }
+    task.info.remaining_instructions = GetRemainingInstructions(task.info.task_id);
+    task.vm_id = VMId_t(-1);
+    task.placement++;
+}
+
+void Mock_Build(unsigned machines, unsigned tasks, uint64_t seed) {
+    Machines.clear();
+    Tasks.clear();
+    VMs.clear();
+    Events = {};
+    Order = 0;
+    Clock = 0;
+    Completed = 0;
+    fill(SLACompleted, SLACompleted + NUM_SLAS, 0);
+    fill(SLAMissed, SLAMissed + NUM_SLAS, 0);
+
+    uint64_t state = seed;
+    for (MachineId_t id = 0; id < machines; id++) {
+        unsigned num_cpus = Random(state) % 2 ? 16 : 8;
+        unsigned mips = 1000 + Random(state) % 4 * 250;
+        MockMachine_t machine;
+        machine.spec = {num_cpus, CPUType_t(id % 4), Random(state) % 2 ? 32768u : 16384u, Random(state) % 3 == 0,
+                        {mips, mips * 3 / 4, mips / 2, mips / 4}, {120, 60, 30, 0}, {120, 90, 70, 50},
+                        {400, 350, 300, 250, 150, 50, 0}, id};
+        machine.status = {0, 0, 0, 0, S0, P0};
+        Machines.push_back(machine);
+    }
+
+    // Arrivals are spread so that about two tasks run per machine on average
+    Time_t mean_duration = 5500000;
+    Time_t spacing = max<Time_t>(1, mean_duration / (2 * max(1u, machines)));
+    for (TaskId_t id = 0; id < tasks; id++) {
+        Time_t arrival = id * spacing;
+        Time_t duration = 1000000 + Random(state) % 9000000;
+        CPUType_t cpu = CPUType_t(Random(state) % 4);
+        SLAType_t sla = SLAType_t(Random(state) % NUM_SLAS);
+        VMType_t vm = cpu == POWER && Random(state) % 2 ? AIX : cpu == X86 && Random(state) % 2 ? WIN : LINUX;
+        uint64_t instructions = (500 + Random(state) % 500) * duration;
+        Time_t target = arrival + duration * (sla == SLA0 ? 12 : sla == SLA1 ? 15 : 20) / 10;
+
+        MockTask_t task;
+        task.info = {false, instructions, instructions, arrival, 0, target, Random(state) % 2 == 0,
+                     MID_PRIORITY, cpu, unsigned(512 + Random(state) % 3584), sla, vm, id};
+        task.rate = double(instructions) / duration;
+        task.vm_id = VMId_t(-1);
+        task.started = 0;
+        task.placement = 0;
+        Tasks.push_back(task);
+        Push(arrival, MOCK_NEW_TASK, id);
+        LastArrival = arrival;
+    }
+    Push(CHECK_PERIOD, MOCK_SCHEDULER_CHECK, 0);
+}
+
+unsigned Mock_CompletedTasks() {
+    return Completed;
+}
+
+bool Mock_NextEvent(MockEvent_t & event) {
+    while (!Events.empty()) {
+        QueuedEvent_t next = Events.top();
+        Events.pop();
+        if (Completed == Tasks.size() || next.event.time > LastArrival + STALL_LIMIT) {
+            return false;
+        }
+        Clock = next.event.time;
+        event = next.event;
+
+        switch (event.type) {
+            case MOCK_TASK_COMPLETION: {
+                MockTask_t & task = Tasks[event.id];
+                if (task.vm_id == VMId_t(-1) || task.placement != next.placement) {
+                    continue;
+                }
+                Unplace(task);
+                task.info.completed = true;
+                task.info.completion = Clock;
+                task.info.remaining_instructions = 0;
+                Completed++;
+                SLACompleted[task.info.required_sla]++;
+                SLAMissed[task.info.required_sla] += Clock > task.info.target_completion;
+                break;
+            }
+            case MOCK_SCHEDULER_CHECK:
+                Push(Clock + CHECK_PERIOD, MOCK_SCHEDULER_CHECK, 0);
+                break;
+            default:
+                break;
+        }
+        return true;
+    }
+    return false;
+}
+
+// Simulator-side interfaces
+
+double GetSLAReport(SLAType_t sla) {
+    return SLACompleted[sla] == 0 ? 0.0 : 100.0 * SLAMissed[sla] / SLACompleted[sla];
+}
+
+Time_t Now() {
+    return Clock;
+}
+
+void SimOutput(string msg, unsigned verbose_level) {
+}
+
+void ThrowException(string err_msg) {
+    throw runtime_error(err_msg);
+}
+
+void ThrowException(string err_msg, string further_input) {
+    throw runtime_error(err_msg + further_input);
+}
+
+void ThrowException(string err_msg, unsigned further_input) {
+    throw runtime_error(err_msg + to_string(further_input));
+}
+
+// Machines
+
+CPUType_t Machine_GetCPUType(MachineId_t machine_id) {
+    return GetMachine(machine_id).spec.cpu;
+}
+
+double Machine_GetClusterEnergy() {
+    return 0.0;
+}
+
+uint64_t Machine_GetEnergy(MachineId_t machine_id) {
+    return 0;
+}
+
+MachineInfo_t Machine_GetInfo(MachineId_t machine_id) {
+    const MockMachine_t & machine = GetMachine(machine_id);
+    const MachineSpec_t & spec = machine.spec;
+    const MachineStatus_t & status = machine.status;
+    return {spec.num_cpus, spec.cpu, spec.memory_size, status.memory_used, status.active_tasks, status.active_vms,
+            spec.gpus, status.energy_consumed, spec.performance, spec.c_states, spec.p_states, spec.s_states,
+            status.s_state, status.p_state, machine_id};
+}
+
+unsigned Machine_GetTotal() {
+    return Machines.size();
+}
+
+void Machine_SetCorePerformance(MachineId_t machine_id, unsigned core_id, CPUPerformance_t p_state) {
+    GetMachine(machine_id).status.p_state = p_state;
+}
+
+void Machine_SetState(MachineId_t machine_id, MachineState_t s_state) {
+    GetMachine(machine_id).status.s_state = s_state;
+    Push(Clock + STATE_CHANGE_DELAY, MOCK_STATE_CHANGE, machine_id);
+}
+
+// Tasks
+
+unsigned GetNumTasks() {
+    return Tasks.size();
+}
+
+uint64_t GetRemainingInstructions(TaskId_t task_id) {
+    const MockTask_t & task = GetTask(task_id);
+    if (task.vm_id == VMId_t(-1)) {
+        return task.info.remaining_instructions;
+    }
+    uint64_t executed = uint64_t(task.rate * (Clock - task.started));
+    return executed >= task.info.remaining_instructions ? 0 : task.info.remaining_instructions - executed;
+}
+
+TaskInfo_t GetTaskInfo(TaskId_t task_id) {
+    TaskInfo_t info = GetTask(task_id).info;
+    info.remaining_instructions = GetRemainingInstructions(task_id);
+    return info;
+}
+
+unsigned GetTaskMemory(TaskId_t task_id) {
+    return GetTask(task_id).info.required_memory;
+}
+
+unsigned GetTaskPriority(TaskId_t task_id) {
+    return GetTask(task_id).info.priority;
+}
+
+bool IsTaskCompleted(TaskId_t task_id) {
+    return GetTask(task_id).info.completed;
+}
+
+bool IsTaskGPUCapable(TaskId_t task_id) {
+    return GetTask(task_id).info.gpu_capable;
+}
+
+CPUType_t RequiredCPUType(TaskId_t task_id) {
+    return GetTask(task_id).info.required_cpu;
+}
+
+SLAType_t RequiredSLA(TaskId_t task_id) {
+    return GetTask(task_id).info.required_sla;
+}
+
+VMType_t RequiredVMType(TaskId_t task_id) {
+    return GetTask(task_id).info.required_vm;
+}
+
+void SetTaskPriority(TaskId_t task_id, Priority_t priority) {
+    GetTask(task_id).info.priority = priority;
+}
+
+// VMs
+
+void VM_AddTask(VMId_t vm_id, TaskId_t task_id, Priority_t priority) {
+    MockVM_t & vm = GetVM(vm_id);
+    MockTask_t & task = GetTask(task_id);
+    if (!vm.attached) {
+        ThrowException("VM_AddTask(): VM is not attached ", vm_id);
+    }
+    if (task.vm_id != VMId_t(-1)) {
+        ThrowException("VM_AddTask(): Task is already placed ", task_id);
+    }
+    MockMachine_t & machine = Machines[vm.info.machine_id];
+    machine.status.memory_used += task.info.required_memory;
+    machine.status.active_tasks++;
+    vm.info.active_tasks.push_back(task_id);
+    task.info.priority = priority;
+    task.vm_id = vm_id;
+    task.started = Clock;
+    Push(Clock + Time_t(task.info.remaining_instructions / task.rate), MOCK_TASK_COMPLETION, task_id, task.placement);
+}
+
+void VM_Attach(VMId_t vm_id, MachineId_t machine_id) {
+    MockVM_t & vm = GetVM(vm_id);
+    MockMachine_t & machine = GetMachine(machine_id);
+    if (vm.attached) {
+        ThrowException("VM_Attach(): VM is already attached ", vm_id);
+    }
+    vm.attached = true;
+    vm.info.machine_id = machine_id;
+    machine.status.memory_used += VM_MEMORY_OVERHEAD;
+    machine.status.active_vms++;
+}
+
+VMId_t VM_Create(VMType_t vm_type, CPUType_t cpu) {
+    VMId_t vm_id = VMs.size();
+    VMs.push_back({{{}, cpu, MachineId_t(-1), vm_id, vm_type}, false});
+    return vm_id;
+}
+
+VMInfo_t VM_GetInfo(VMId_t vm_id) {
+    return GetVM(vm_id).info;
+}
+
+void VM_Migrate(VMId_t vm_id, MachineId_t machine_id) {
+    MockVM_t & vm = GetVM(vm_id);
+    if (!vm.attached) {
+        ThrowException("VM_Migrate(): VM is not attached ", vm_id);
+    }
+    unsigned memory = VM_MEMORY_OVERHEAD;
+    for (TaskId_t task_id : vm.info.active_tasks) {
+        memory += Tasks[task_id].info.required_memory;
+    }
+    MockMachine_t & from = Machines[vm.info.machine_id];
+    MockMachine_t & to = GetMachine(machine_id);
+    from.status.memory_used -= memory;
+    from.status.active_tasks -= vm.info.active_tasks.size();
+    from.status.active_vms--;
+    to.status.memory_used += memory;
+    to.status.active_tasks += vm.info.active_tasks.size();
+    to.status.active_vms++;
+    vm.info.machine_id = machine_id;
+    Push(Clock + MIGRATION_DELAY, MOCK_MIGRATION_DONE, vm_id);
+}
+
+void VM_RemoveTask(VMId_t vm_id, TaskId_t task_id) {
+    MockTask_t & task = GetTask(task_id);
+    if (task.vm_id != vm_id) {
+        ThrowException("VM_RemoveTask(): Task is not on this VM ", task_id);
+    }
+    Unplace(task);
+}
+
+void VM_Shutdown(VMId_t vm_id) {
+    MockVM_t & vm = GetVM(vm_id);
+    while (!vm.info.active_tasks.empty()) {
+        Unplace(Tasks[vm.info.active_tasks.back()]);
+    }
+    if (vm.attached) {
+        MockMachine_t & machine = Machines[vm.info.machine_id];
+        machine.status.memory_used -= VM_MEMORY_OVERHEAD;
+        machine.status.active_vms--;
+        vm.attached = false;
+    }
+}
@@ -0,0 +1,40 @@
+//
+//  MockSimulator.hpp
+//  CloudSim
+//
+//  In-memory stand-in for the simulator modules behind Interfaces.h, used by
+//  the scheduler benchmark. It builds a synthetic cluster and workload from a
+//  seed and hands out the events a scheduler would see, in time order; the
+//  caller dispatches them to the scheduler interface. Tasks run at a fixed
+//  rate from the moment they are added to a VM, so completions depend only on
+//  the placement decisions. Energy is not modelled.
+//
+
+#ifndef MockSimulator_hpp
+#define MockSimulator_hpp
+
+#include "SimTypes.h"
+
+typedef enum {
+    MOCK_NEW_TASK,
+    MOCK_TASK_COMPLETION,
+    MOCK_SCHEDULER_CHECK,
+    MOCK_STATE_CHANGE,
+    MOCK_MIGRATION_DONE
+} MockEventType_t;
+
+typedef struct {
+    Time_t time;
+    MockEventType_t type;
+    unsigned id;                    // Task, machine or VM, depending on the type
+} MockEvent_t;
+
+// Replaces any earlier cluster and workload
+extern void Mock_Build(unsigned machines, unsigned tasks, uint64_t seed);
+// Tasks completed so far; short of the total once a run has stalled
+extern unsigned Mock_CompletedTasks();
+// Advances Now() to the next event and applies its effect on the simulated
+// state; returns false once every task has completed or the run stalls
+extern bool Mock_NextEvent(MockEvent_t & event);
+
+#endif /* MockSimulator_hpp */
@@ -0,0 +1,131 @@
+//
+//  PStateController.cpp
+//  CloudSim
+//
+
+#include "PStateController.hpp"
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
+#include "Interfaces.h"
+
+// Fraction of the MIPS of a P-state the deadlines may ask for, the rest covers
+// sharing the cores with other tasks and the time until the next evaluation
+const double PSTATE_HEADROOM = 0.8;
+
+void PStateController::AddTask(TaskId_t task_id, MachineId_t machine_id, Priority_t priority, Time_t now) {
+    if (task_machines.count(task_id)) {
+        ThrowException("PStateController::AddTask(): Task is already placed ", task_id);
+    }
+    task_machines[task_id] = machine_id;
+    machine_tasks[machine_id].push_back({task_id, priority});
+    busy.Add(machine_id);
+    Evaluate(machine_id, now);
+}
+
+// P-state for the tasks on the machine, P3 once it has none
+CPUPerformance_t PStateController::Choose(MachineId_t machine_id, Time_t now) const {
+    const vector<TaskEntry> & tasks = machine_tasks[machine_id];
+    if (tasks.empty()) {
+        return P3;
+    }
+    if (!slack) {
+        return P0;
+    }
+
+    // rate every task needs, summed up and at its peak per priority
+    double total_mips[PRIORITY_LEVELS] = {};
+    double peak_mips[PRIORITY_LEVELS] = {};
+    unsigned count[PRIORITY_LEVELS] = {};
+    for (auto & [task_id, priority] : tasks) {
+        uint64_t remaining_instr = GetTaskRemainingInstructions(task_id);
+        // remaining instructions can wrap around as a task finishes
+        if (remaining_instr > GetTaskTotalInstructions(task_id)) {
+            continue;
+        }
+        Time_t target = GetTaskTargetCompletion(task_id);
+        if (target <= now) {
+            return P0;
+        }
+        double mips = (double) remaining_instr / (double) (target - now);
+        total_mips[priority] += mips;
+        peak_mips[priority] = max(peak_mips[priority], mips);
+        count[priority]++;
+    }
+
+    // The cores go to the higher priorities first and are time sliced evenly
+    // over the tasks of a priority, so every task gets at least its share of
+    // what the higher priorities leave, and never more than one core. Of the
+    // P-states that fit, the one with the least energy per instruction wins;
+    // on a tie the faster one, as a running task keeps the speed it started at
+    // until the machine has to time slice.
+    const MachineSpec_t & machine = Machine_GetSpec(machine_id);
+    CPUPerformance_t best = P0;
+    for (int p_state = P1; p_state <= P3; p_state++) {
+        double core_mips = machine.performance[p_state] * PSTATE_HEADROOM;
+        double left_mips = core_mips * machine.num_cpus;
+        bool fits = true;
+        for (unsigned priority = 0; priority < PRIORITY_LEVELS && fits; priority++) {
+            if (count[priority] == 0) {
+                continue;
+            }
+            fits = peak_mips[priority] <= min(core_mips, left_mips / count[priority]);
+            left_mips -= total_mips[priority];
+        }
+        if (!fits) {
+            break;
+        }
+        if (machine.p_states[p_state] * machine.performance[best] < machine.p_states[best] * machine.performance[p_state]) {
+            best = CPUPerformance_t(p_state);
+        }
+    }
+    return best;
+}
+
+void PStateController::Evaluate(MachineId_t machine_id, Time_t now) {
+    CPUPerformance_t p_state = Choose(machine_id, now);
+    if (p_state != p_states[machine_id]) {
+        Machine_SetCorePerformance(machine_id, 0, p_state);
+        p_states[machine_id] = p_state;
+    }
+}
+
+void PStateController::Init(unsigned total_machines) {
+    const char * mode = getenv("SIM_DVFS");
+    slack = mode != nullptr && strcmp(mode, "slack") == 0;
+    machine_tasks.assign(total_machines, {});
+    task_machines.clear();
+    p_states.clear();
+    for (MachineId_t id = 0; id < total_machines; id++) {
+        p_states.push_back(Machine_GetStatus(id).p_state);
+    }
+    busy = MachinePool();
+}
+
+void PStateController::Refresh(Time_t now) {
+    if (!slack) {
+        return;
+    }
+    for (MachineId_t id : busy) {
+        Evaluate(id, now);
+    }
+}
+
+void PStateController::RemoveTask(TaskId_t task_id, Time_t now) {
+    auto it = task_machines.find(task_id);
+    if (it == task_machines.end()) {
+        ThrowException("PStateController::RemoveTask(): Task is not placed ", task_id);
+    }
+    MachineId_t machine_id = it->second;
+    task_machines.erase(it);
+
+    vector<TaskEntry> & tasks = machine_tasks[machine_id];
+    *find_if(tasks.begin(), tasks.end(), [task_id](const TaskEntry & entry) { return entry.task_id == task_id; }) = tasks.back();
+    tasks.pop_back();
+    if (tasks.empty()) {
+        busy.Remove(machine_id);
+    }
+    Evaluate(machine_id, now);
+}
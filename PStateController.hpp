@@ -0,0 +1,49 @@
+//
+//  PStateController.hpp
+//  CloudSim
+//
+//  Per-machine DVFS. The controller keeps the tasks placed on every machine,
+//  runs a machine with tasks at P0 and drops it to P3 once it has none. With
+//  SIM_DVFS=slack it runs a busy machine instead at the P-state, of those whose
+//  MIPS still finish every resident task by its target completion, with the
+//  least energy per instruction: the remaining instructions over the time left
+//  give the rate a task needs, which has to fit in its share of the cores. A
+//  machine is re-evaluated when it gains or loses a task, and all busy machines
+//  again on Refresh(), since the rates rise as the targets come closer.
+//
+
+#ifndef PStateController_hpp
+#define PStateController_hpp
+
+#include <unordered_map>
+#include <vector>
+
+#include "MachinePool.hpp"
+#include "SimTypes.h"
+
+class PStateController {
+public:
+    PStateController()          {}
+    // The priority is the one the task is about to be added to its VM with
+    void AddTask(TaskId_t task_id, MachineId_t machine_id, Priority_t priority, Time_t now);
+    void Init(unsigned total_machines);
+    CPUPerformance_t PState(MachineId_t machine_id) const   { return p_states[machine_id]; }
+    void Refresh(Time_t now);
+    void RemoveTask(TaskId_t task_id, Time_t now);
+private:
+    struct TaskEntry {
+        TaskId_t task_id;
+        Priority_t priority;
+    };
+
+    CPUPerformance_t Choose(MachineId_t machine_id, Time_t now) const;
+    void Evaluate(MachineId_t machine_id, Time_t now);
+
+    vector<vector<TaskEntry>> machine_tasks;
+    unordered_map<TaskId_t, MachineId_t> task_machines;
+    vector<CPUPerformance_t> p_states;
+    MachinePool busy;
+    bool slack = false;
+};
+
+#endif /* PStateController_hpp */
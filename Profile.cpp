@@ -0,0 +1,101 @@
+//
+//  Profile.cpp
+//  CloudSim
+//
+
+#include "Profile.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+static const unsigned SUB_BITS = 4;
+static const unsigned SUB_BUCKETS = 1 << SUB_BITS;
+// Values below 2 * SUB_BUCKETS get a bucket each, every power of two above gets SUB_BUCKETS
+static const unsigned BUCKETS = 2 * SUB_BUCKETS + (64 - SUB_BITS - 1) * SUB_BUCKETS;
+
+typedef struct {
+    uint64_t count;
+    uint64_t total;
+    uint64_t max;
+    uint64_t buckets[BUCKETS];
+} Histogram_t;
+
+static const char * Names[PROFILE_CALLBACKS] = {
+    "HandleNewTask", "HandleTaskCompletion", "SchedulerCheck", "StateChangeComplete",
+    "MigrationDone", "SLAWarning", "MemoryWarning"
+};
+
+bool Profile_On = false;
+static Histogram_t Histograms[PROFILE_CALLBACKS];
+
+static unsigned Bucket(uint64_t ticks) {
+    if (ticks < 2 * SUB_BUCKETS) {
+        return ticks;
+    }
+    unsigned exponent = 63 - __builtin_clzll(ticks);
+    return 2 * SUB_BUCKETS + (exponent - SUB_BITS - 1) * SUB_BUCKETS + ((ticks >> (exponent - SUB_BITS)) - SUB_BUCKETS);
+}
+
+// Smallest value that falls in the bucket
+static uint64_t BucketValue(unsigned bucket) {
+    if (bucket < 2 * SUB_BUCKETS) {
+        return bucket;
+    }
+    unsigned exponent = (bucket - 2 * SUB_BUCKETS) / SUB_BUCKETS + SUB_BITS + 1;
+    uint64_t sub = (bucket - 2 * SUB_BUCKETS) % SUB_BUCKETS;
+    return (SUB_BUCKETS + sub) << (exponent - SUB_BITS);
+}
+
+static uint64_t Percentile(const Histogram_t & histogram, double p) {
+    uint64_t rank = uint64_t(p * (histogram.count - 1));
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < BUCKETS; i++) {
+        seen += histogram.buckets[i];
+        if (seen > rank) {
+            return BucketValue(i);
+        }
+    }
+    return histogram.max;
+}
+
+void Profile_Init() {
+    const char * setting = getenv("SIM_PROFILE");
+    Profile_On = setting != nullptr && *setting != '\0' && strcmp(setting, "0") != 0;
+    memset(Histograms, 0, sizeof(Histograms));
+}
+
+void Profile_Record(ProfileCallback_t callback, uint64_t ticks) {
+    Histogram_t & histogram = Histograms[callback];
+    histogram.count++;
+    histogram.total += ticks;
+    histogram.max = histogram.max < ticks ? ticks : histogram.max;
+    histogram.buckets[Bucket(ticks)]++;
+}
+
+void Profile_Report(Time_t time) {
+    if (!Profile_On) {
+        return;
+    }
+#if defined(__x86_64__) || defined(__i386__)
+    const char * unit = "cycles";
+#else
+    const char * unit = "ns";
+#endif
+    double seconds = double(time) / 1000000;
+    printf("Callback profile (%s)\n", unit);
+    printf("%-21s %10s %10s %10s %10s %10s %10s %10s %10s\n", "callback", "calls", "per_sim_s", "mean", "p50", "p90", "p99", "p99.9", "max");
+    for (unsigned i = 0; i < PROFILE_CALLBACKS; i++) {
+        const Histogram_t & histogram = Histograms[i];
+        if (histogram.count == 0) {
+            continue;
+        }
+        printf("%-21s %10llu %10.1f %10llu %10llu %10llu %10llu %10llu %10llu\n", Names[i],
+               (unsigned long long) histogram.count, seconds > 0 ? histogram.count / seconds : 0.0,
+               (unsigned long long) (histogram.total / histogram.count),
+               (unsigned long long) Percentile(histogram, 0.5), (unsigned long long) Percentile(histogram, 0.9),
+               (unsigned long long) Percentile(histogram, 0.99), (unsigned long long) Percentile(histogram, 0.999),
+               (unsigned long long) histogram.max);
+    }
+    fflush(stdout);
+}
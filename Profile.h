@@ -0,0 +1,63 @@
+//
+//  Profile.h
+//  CloudSim
+//
+//  Latency histograms for the scheduler entry points. Put a ProfileScope at the
+//  top of a callback to time it:
+//
+//      ProfileScope profile(PROFILE_NEW_TASK);
+//
+//  Profiling is off unless SIM_PROFILE is set to something other than 0 when
+//  the scheduler is initialized; while off a scope costs one test of a flag.
+//  Times are CPU cycles where the time stamp counter is available and
+//  nanoseconds elsewhere. Each callback keeps an HDR-style histogram, with 16
+//  linear buckets per power of two, so percentiles are within 1/16 of the true
+//  value. Profile_Report() prints them.
+//
+
+#ifndef Profile_h
+#define Profile_h
+
+#include <chrono>
+
+#include "SimTypes.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+typedef enum {
+    PROFILE_NEW_TASK,
+    PROFILE_TASK_COMPLETION,
+    PROFILE_SCHEDULER_CHECK,
+    PROFILE_STATE_CHANGE,
+    PROFILE_MIGRATION_DONE,
+    PROFILE_SLA_WARNING,
+    PROFILE_MEMORY_WARNING
+} ProfileCallback_t;
+#define PROFILE_CALLBACKS 7
+
+extern bool             Profile_On;
+
+extern void             Profile_Init();                                 // Reads SIM_PROFILE, clears the histograms
+extern void             Profile_Record(ProfileCallback_t callback, uint64_t ticks);
+extern void             Profile_Report(Time_t time);                    // time is the simulated run length
+
+inline uint64_t Profile_Ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+class ProfileScope {
+public:
+    ProfileScope(ProfileCallback_t callback)    : callback(callback), start(Profile_On ? Profile_Ticks() : 0) {}
+    ~ProfileScope()                             { if (Profile_On) Profile_Record(callback, Profile_Ticks() - start); }
+private:
+    ProfileCallback_t callback;
+    uint64_t start;
+};
+
+#endif /* Profile_h */
@@ -0,0 +1,282 @@
+//
+//  Runner.cpp
+//  CloudSim
+//
+//  Runs the simulator over every input x scheduler x seed x run on a pool of
+//  worker processes and collects the SimulationComplete() report of each into
+//  one CSV table:
+//
+//      runner [-j workers] [-s sched,sched,...] [-S seed,seed,...] [-r runs] [-x simulator] [-o out.csv] input...
+//
+//  Every simulation is its own process, so the policies do not have to be
+//  reentrant. The scheduler is picked through SIM_SCHEDULER. Without -S the
+//  inputs run with their own seeds. With -S every seed gets a temporary copy
+//  of the input in which the k-th task class has Seed: seed + k, so the
+//  classes keep drawing different arrivals from each other.
+//
+
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace std;
+using namespace std::chrono;
+
+typedef struct {
+    string input;
+    string scheduler;
+    string seed;                    // Empty for the seeds of the input
+    unsigned run;
+    string path;                    // What the simulator reads, a reseeded copy with -S
+
+    // Filled in as the simulation reports
+    bool finished;
+    int exit_code;
+    double sla[3];
+    double energy;
+    double sim_seconds;
+    double wall_ms;
+} Job_t;
+
+typedef struct {
+    size_t job;
+    pid_t pid;
+    int fd;
+    string partial;                 // Output after the last newline
+    steady_clock::time_point start;
+} Worker_t;
+
+static void Usage(const char * name) {
+    cerr << "Usage: " << name << " [-j workers] [-s sched,sched,...] [-S seed,seed,...] [-r runs] [-x simulator] [-o out.csv] input..." << endl;
+    exit(1);
+}
+
+static vector<string> Split(const string & list) {
+    vector<string> items;
+    stringstream in(list);
+    string item;
+    while (getline(in, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+// Writes a temporary copy of the input with its Seed: lines replaced and
+// returns its path
+static string Reseed(const string & input, uint64_t seed) {
+    ifstream in(input);
+    if (!in) {
+        cerr << "Cannot open " << input << endl;
+        exit(1);
+    }
+    char path[] = "/tmp/runner-XXXXXX";
+    int fd = mkstemp(path);
+    if (fd < 0) {
+        perror("mkstemp");
+        exit(1);
+    }
+    close(fd);
+    ofstream out(path);
+    string line;
+    uint64_t task_class = 0;
+    while (getline(in, line)) {
+        size_t tag = line.find("Seed:");
+        if (tag != string::npos) {
+            line = line.substr(0, tag) + "Seed: " + to_string(seed + task_class++);
+        }
+        out << line << "\n";
+    }
+    if (!out) {
+        cerr << "Cannot write " << path << endl;
+        exit(1);
+    }
+    return path;
+}
+
+// Picks the figures out of the lines SimulationComplete() prints
+static void ParseLine(const string & line, Job_t & job) {
+    static const char * sla_tags[] = {"SLA0: ", "SLA1: ", "SLA2: "};
+    for (unsigned i = 0; i < 3; i++) {
+        if (line.compare(0, strlen(sla_tags[i]), sla_tags[i]) == 0) {
+            job.sla[i] = atof(line.c_str() + strlen(sla_tags[i]));
+            return;
+        }
+    }
+    if (line.compare(0, 13, "Total Energy ") == 0) {
+        job.energy = atof(line.c_str() + 13);
+    } else if (line.compare(0, 27, "Simulation run finished in ") == 0) {
+        job.sim_seconds = atof(line.c_str() + 27);
+        job.finished = true;
+    }
+}
+
+static Worker_t Start(const string & simulator, size_t index, const Job_t & job) {
+    int fds[2];
+    if (pipe(fds) != 0) {
+        perror("pipe");
+        exit(1);
+    }
+    Worker_t worker = {index, 0, fds[0], "", steady_clock::now()};
+    worker.pid = fork();
+    if (worker.pid < 0) {
+        perror("fork");
+        exit(1);
+    }
+    if (worker.pid == 0) {
+        close(fds[0]);
+        dup2(fds[1], STDOUT_FILENO);
+        dup2(fds[1], STDERR_FILENO);
+        close(fds[1]);
+        setenv("SIM_SCHEDULER", job.scheduler.c_str(), 1);
+        execl(simulator.c_str(), simulator.c_str(), job.path.c_str(), (char *) nullptr);
+        perror(simulator.c_str());
+        _exit(127);
+    }
+    close(fds[1]);
+    return worker;
+}
+
+// Returns false once the simulator has closed its output and been reaped
+static bool Drain(Worker_t & worker, Job_t & job) {
+    char buffer[65536];
+    ssize_t n = read(worker.fd, buffer, sizeof(buffer));
+    if (n > 0) {
+        worker.partial.append(buffer, n);
+        size_t begin = 0;
+        for (size_t end = worker.partial.find('\n'); end != string::npos; end = worker.partial.find('\n', begin)) {
+            ParseLine(worker.partial.substr(begin, end - begin), job);
+            begin = end + 1;
+        }
+        worker.partial.erase(0, begin);
+        return true;
+    }
+    if (n < 0 && errno == EINTR) {
+        return true;
+    }
+
+    close(worker.fd);
+    int status = 0;
+    waitpid(worker.pid, &status, 0);
+    job.exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+    job.wall_ms = duration<double, milli>(steady_clock::now() - worker.start).count();
+    return false;
+}
+
+int main(int argc, char * argv[]) {
+    unsigned workers = max(1u, thread::hardware_concurrency());
+    vector<string> schedulers = {"default"};
+    vector<string> seeds = {""};
+    unsigned runs = 1;
+    string simulator = "./simulator";
+    string output;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "j:s:S:r:x:o:")) != -1) {
+        switch (opt) {
+            case 'j':   workers = max(1, atoi(optarg)); break;
+            case 's':   schedulers = Split(optarg); break;
+            case 'S':   seeds = Split(optarg); break;
+            case 'r':   runs = max(1, atoi(optarg)); break;
+            case 'x':   simulator = optarg; break;
+            case 'o':   output = optarg; break;
+            default:    Usage(argv[0]);
+        }
+    }
+    if (optind == argc || schedulers.empty() || seeds.empty()) {
+        Usage(argv[0]);
+    }
+    for (const string & seed : seeds) {
+        if (!seed.empty() && seed.find_first_not_of("0123456789") != string::npos) {
+            Usage(argv[0]);
+        }
+    }
+
+    // One copy per input and seed, shared by the schedulers and runs
+    vector<string> copies;
+    vector<Job_t> jobs;
+    for (int i = optind; i < argc; i++) {
+        for (const string & seed : seeds) {
+            string path = argv[i];
+            if (!seed.empty()) {
+                path = Reseed(argv[i], strtoull(seed.c_str(), nullptr, 10));
+                copies.push_back(path);
+            }
+            for (const string & scheduler : schedulers) {
+                for (unsigned run = 0; run < runs; run++) {
+                    jobs.push_back({argv[i], scheduler, seed, run, path, false, -1, {0, 0, 0}, 0, 0, 0});
+                }
+            }
+        }
+    }
+
+    vector<Worker_t> running;
+    size_t next = 0, done = 0;
+    while (done < jobs.size()) {
+        while (running.size() < workers && next < jobs.size()) {
+            running.push_back(Start(simulator, next, jobs[next]));
+            next++;
+        }
+
+        vector<pollfd> fds;
+        for (const Worker_t & worker : running) {
+            fds.push_back({worker.fd, POLLIN, 0});
+        }
+        if (poll(fds.data(), fds.size(), -1) < 0 && errno != EINTR) {
+            perror("poll");
+            exit(1);
+        }
+
+        // Walk backwards so that finished workers can be swapped out in place
+        for (size_t i = running.size(); i-- > 0;) {
+            if (fds[i].revents == 0) {
+                continue;
+            }
+            Job_t & job = jobs[running[i].job];
+            if (!Drain(running[i], job)) {
+                done++;
+                cerr << "[" << done << "/" << jobs.size() << "] " << job.input << " " << job.scheduler
+                     << (job.seed.empty() ? "" : " seed " + job.seed)
+                     << (job.finished && job.exit_code == 0 ? "" : " FAILED") << endl;
+                running[i] = running.back();
+                running.pop_back();
+            }
+        }
+    }
+
+    for (const string & path : copies) {
+        unlink(path.c_str());
+    }
+
+    ofstream file;
+    if (!output.empty()) {
+        file.open(output);
+        if (!file) {
+            cerr << "Cannot open " << output << endl;
+            return 1;
+        }
+    }
+    ostream & out = output.empty() ? cout : file;
+    out << "input,scheduler,seed,run,status,sla0,sla1,sla2,energy_kwh,sim_seconds,wall_ms" << endl;
+    unsigned failed = 0;
+    for (const Job_t & job : jobs) {
+        bool ok = job.finished && job.exit_code == 0;
+        failed += !ok;
+        out << job.input << "," << job.scheduler << "," << job.seed << "," << job.run << "," << (ok ? "ok" : "failed") << ","
+            << job.sla[0] << "," << job.sla[1] << "," << job.sla[2] << ","
+            << job.energy << "," << job.sim_seconds << "," << job.wall_ms << endl;
+    }
+    return failed == 0 ? 0 : 2;
+}
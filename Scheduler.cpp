@@ -6,74 +6,149 @@
 // Custom
 
 #include "Scheduler.hpp"
+#include "CapacityIndex.hpp"
+#include "DemandForecast.hpp"
+#include "DemandLedger.hpp"
+#include "Log.h"
+#include "MachinePool.hpp"
+#include "PStateController.hpp"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 #include <math.h>
 #include <deque>
+#include <queue>
 
-// Managing machines
-vector<vector<MachineId_t>> machine_matrix;
+namespace default_policy {
 
-unsigned total_machines;
+// Reusable vm per machine and vm type, NO_VM until one is opened
+const VMId_t NO_VM = VMId_t(-1);
 
-// Current mips of task
-double task_eff_mips(MachineId_t machine_id, TaskId_t task_id, Time_t curr) {
-    TaskInfo_t info = GetTaskInfo(task_id);
+const MachineState_t RUNNING_S_STATE = S0;
+const CPUPerformance_t IDLE_P_STATE = P3;
+const MachineState_t OFF_S_STATE = S1;
+// What the simulator takes to bring a machine from S1 back to S0, until the
+// policy has timed a wake of its own
+const Time_t OFF_WAKE_LATENCY = 300000;
+
+struct stateChangeInfo {
+    MachineState_t old_state;
+    MachineState_t new_state;
+    bool attach_task;
+    TaskId_t task;
+};
+
+// For Idle set adjustment
+const uint64_t SECOND = 1000000;
+
+class Scheduler : public SchedulerPolicy {
+public:
+    Scheduler()                 {}
+    void Init();
+    void MigrationComplete(Time_t time, VMId_t vm_id);
+    void NewTask(Time_t now, TaskId_t task_id);
+    void PeriodicCheck(Time_t now);
+    void Sample(TelemetrySample_t & sample);
+    void Shutdown(Time_t now);
+    void StateChangeComplete(Time_t time, MachineId_t machine_id);
+    void TaskComplete(Time_t now, TaskId_t task_id);
+private:
+    vector<VMId_t> vms;
+    vector<MachineId_t> machines;
+
+    void FindVMAddTask(MachineId_t id, TaskId_t task_id);
+    double machine_eff_mips(MachineId_t machine_id, Time_t curr);
+    bool PlaceOnIdle(TaskId_t task_id, const TaskRequirements_t & task, bool need_gpu, Time_t now);
+    bool PlaceOnRunning(TaskId_t task_id, const TaskRequirements_t & task, bool need_gpu, Time_t now);
+    bool PlaceTask(TaskId_t task_id, Time_t now);
+    void RebookDemand(Time_t now);
+    void UpdateCapacity(CapacityIndex & index, MachineId_t id, Time_t now);
+    void updateWaitingQueue(Time_t now);
+    unsigned vm_eff_mips(MachineId_t machine_id, VMId_t vm_id, Time_t curr);
+    void WaitForCapacity(TaskId_t task_id);
+
+    // Managing machines
+    vector<vector<MachineId_t>> machine_matrix;
+    vector<array<VMId_t, NUM_VM_TYPES>> machine_vms;
+
+    unsigned total_machines = 0;
+
+    // Booked mips per task, vm and machine
+    DemandLedger ledger;
+    // Demand of the running and idle machines before the last rebook
+    vector<double> booked_mips;
+    // P-state of every machine from the tasks placed on it
+    PStateController dvfs;
+
+    // Managing states
+    vector<MachinePool> running;
+    vector<MachinePool> idle;
+    vector<MachinePool> off;
+
+    unordered_map<unsigned, stateChangeInfo> idle_adjust_set;
+    unordered_map<unsigned, stateChangeInfo> changing_state;
+
+    uint64_t last_time = 0;
+    uint64_t wait_queue_time = 0;
+
+    // Waiting tasks, one fifo per (cpu, gpu capable, sla)
+    vector<deque<TaskId_t>> wait_shards;
+    // Set when capacity is freed on a cpu type, cleared once its shards are drained
+    vector<bool> cpu_freed;
+    // Target completions of the tasks waiting on each cpu type, earliest first.
+    // Entries of tasks placed since are skipped as they come up.
+    vector<priority_queue<pair<Time_t, TaskId_t>, vector<pair<Time_t, TaskId_t>>, greater<pair<Time_t, TaskId_t>>>> wait_targets;
+    unordered_set<TaskId_t> waiting_tasks;
+
+    vector<vector<uint64_t>> machine_by_cpus;
+
+    // Headroom of running and idle machines, per cpu type
+    vector<CapacityIndex> running_capacity;
+    vector<CapacityIndex> idle_capacity;
+
+    unordered_map<unsigned, unsigned> task_to_vm;
+
+    //machine -> last active time
+    unordered_map<unsigned, uint64_t> last_active;
+
+    // Booked plus waiting mips per cpu type, sampled every tenth of a second
+    vector<DemandForecast> forecasts;
+    // Time to wake up from each s-state, and when the wakes in flight started
+    array<Time_t, S_STATES> wake_latency = {};
+    unordered_map<unsigned, Time_t> wake_started;
+};
 
+// Mips a task needs at curr, the demand the ledger books
+double task_demand(uint64_t remaining_instr, uint64_t total_instr, Time_t target, Time_t curr) {
     // somehow, remaining_instr is subject to unsigned integer overflow
-    if (info.remaining_instructions > info.total_instructions) {
+    if (remaining_instr > total_instr) {
         return 0;
     }
 
-    uint64_t remaining_instr = info.remaining_instructions;
-    uint64_t time_frame = info.target_completion - curr;
+    uint64_t time_frame = target - curr;
 
     double eff_mips = (double) remaining_instr / (double) time_frame;
 
 	return eff_mips;
 }
 
-// Current mips of vm
-unsigned vm_eff_mips(MachineId_t machine_id, VMId_t vm_id, Time_t curr) {
-    unsigned eff_mips = 0;
-
-    for (TaskId_t task_id : VM_GetInfo(vm_id).active_tasks) {
-        TaskInfo_t info = GetTaskInfo(task_id);
-
-        uint64_t remaining_instr = info.remaining_instructions;
-        uint64_t time_frame = info.target_completion - curr;
-
-        eff_mips += remaining_instr / time_frame;
-    }
-    
-	return eff_mips;
+// Current mips of task
+double task_eff_mips(MachineId_t machine_id, TaskId_t task_id, Time_t curr) {
+    return task_demand(GetTaskRemainingInstructions(task_id), GetTaskTotalInstructions(task_id), GetTaskTargetCompletion(task_id), curr);
 }
 
-// Current mips of machine
-double machine_eff_mips(MachineId_t machine_id, Time_t curr) {
-    double eff_mips = 0.0;
-
-    for (VMId_t vm_id : machine_matrix[machine_id]) {
-        for (TaskId_t task_id : VM_GetInfo(vm_id).active_tasks) {
-            TaskInfo_t info = GetTaskInfo(task_id);
-
-            uint64_t remaining_instr = info.remaining_instructions;
-            uint64_t time_frame = info.target_completion - curr;
-
-            // somehow, remaining_instr is subject to unsigned integer overflow
-            if (remaining_instr > info.total_instructions) {
-                continue;
-            }
+// Booked mips of vm
+unsigned Scheduler::vm_eff_mips(MachineId_t machine_id, VMId_t vm_id, Time_t curr) {
+	return ledger.VMDemand(vm_id);
+}
 
-            eff_mips += (double) remaining_instr / (double) time_frame;
-        }
-    }
-    
-    return eff_mips;
+// Booked mips of machine, the sum of task_eff_mips of its tasks
+double Scheduler::machine_eff_mips(MachineId_t machine_id, Time_t curr) {
+    return ledger.MachineDemand(machine_id);
 }
 
 // Converts SLA to Priority
@@ -87,63 +162,41 @@ Priority_t sla_to_prio(SLAType_t sla) {
     return LOW_PRIORITY;
 }
 
-// Managing states
-vector<vector<uint64_t>> running;
-vector<vector<uint64_t>> idle;
-vector<vector<uint64_t>> off;
-
-const CPUPerformance_t RUNNING_P_STATE = P0;
-const MachineState_t RUNNING_S_STATE = S0;
-const CPUPerformance_t IDLE_P_STATE = P3;
-const MachineState_t OFF_S_STATE = S1;
-
-struct stateChangeInfo {
-    MachineState_t old_state;
-    MachineState_t new_state;
-    bool attach_task;
-    TaskId_t task;
-};
-
-unordered_map<unsigned, stateChangeInfo> idle_adjust_set;
-unordered_map<unsigned, stateChangeInfo> changing_state;
-
-// For Idle set adjustment
-const uint64_t SECOND = 1000000;
-
-uint64_t last_time = 0;
-uint64_t wait_queue_time = 0;
-
-deque<unsigned> queue;
-
-vector<vector<uint64_t>> machine_by_cpus;
-
-unordered_map<unsigned, unsigned> task_to_vm;
-
-//machine -> last active time
-unordered_map<unsigned, uint64_t> last_active;
+unsigned shard_of(CPUType_t cpu, bool gpu_capable, SLAType_t sla) {
+    return (cpu * 2 + gpu_capable) * NUM_SLAS + sla;
+}
 
 // Find suitable VM (or create one) on Machine for Task
-void FindVMAddTask(MachineId_t id, TaskId_t task_id) {
-    MachineInfo_t machine = Machine_GetInfo(id);
-    TaskInfo_t task = GetTaskInfo(task_id);
-    
-    for (VMId_t vm : machine_matrix[id]) {
-        if (task.required_vm == VM_GetInfo(vm).vm_type) {
-            VM_AddTask(vm, task_id, sla_to_prio(task.required_sla));
-            task_to_vm[task_id] = vm;
-            return;
-        }
+void Scheduler::FindVMAddTask(MachineId_t id, TaskId_t task_id) {
+    const MachineSpec_t & machine = Machine_GetSpec(id);
+    VMType_t required_vm = RequiredVMType(task_id);
+    Priority_t priority = sla_to_prio(RequiredSLA(task_id));
+
+    // Tasks of the same vm type share one vm per machine; open it on first use
+    VMId_t & vm = machine_vms[id][required_vm];
+    if (vm == NO_VM) {
+        vm = VM_Create(required_vm, machine.cpu);
+        VM_Attach(vm, id);
+        machine_matrix[id].push_back(vm);
     }
 
-    VMId_t new_vm = VM_Create(task.required_vm, machine.cpu);
-    VM_Attach(new_vm, id);
-    machine_matrix[id].push_back(new_vm);
-
-    VM_AddTask(new_vm, task_id, sla_to_prio(task.required_sla));
-    task_to_vm[task_id] = new_vm;
+    // the task starts at the p-state the machine has when it is added
+    dvfs.AddTask(task_id, id, priority, Now());
+    VM_AddTask(vm, task_id, priority);
+    ledger.AddTask(task_id, vm, id, Now());
+    task_to_vm[task_id] = vm;
     return;
 }
 
+// Refresh the headroom and free memory of a machine in the given index
+void Scheduler::UpdateCapacity(CapacityIndex & index, MachineId_t id, Time_t now) {
+    const MachineSpec_t & machine = Machine_GetSpec(id);
+    MachineStatus_t machine_state = Machine_GetStatus(id);
+    double machine_max_util = machine.performance[P0] * machine.num_cpus;
+    unsigned free_memory = machine_state.memory_used < machine.memory_size ? machine.memory_size - machine_state.memory_used : 0;
+
+    index.Update(id, machine_max_util - machine_eff_mips(id, now), free_memory);
+}
 
 void Scheduler::Init() {
     // Find the parameters of the clusters
@@ -155,30 +208,46 @@ void Scheduler::Init() {
     //      Get if there is a GPU or not
     
     total_machines = Machine_GetTotal();
+    ledger.Init(total_machines, task_demand);
+    booked_mips.assign(total_machines, 0.0);
 
     // we have four cpus
     for(int i = 0 ; i < 4; i++) {
         vector<uint64_t> temp = {};
         machine_by_cpus.push_back(temp);
-        vector<uint64_t> temp2 = {};
-        running.push_back(temp2);
-        vector<uint64_t> temp3 = {};
-        idle.push_back(temp3);        
-        vector<uint64_t> temp4 = {};
-        off.push_back(temp4);
+        running.push_back(MachinePool());
+        idle.push_back(MachinePool());
+        off.push_back(MachinePool());
+        forecasts.push_back(DemandForecast());
     }
+    wake_latency[OFF_S_STATE] = OFF_WAKE_LATENCY;
+    wait_shards.resize(machine_by_cpus.size() * 2 * NUM_SLAS);
+    cpu_freed.assign(machine_by_cpus.size(), false);
+    wait_targets.resize(machine_by_cpus.size());
     
     for(int i = 0; i < total_machines; i++) {
-        machine_by_cpus[Machine_GetInfo((MachineId_t) i).cpu].push_back(i);
+        machine_by_cpus[Machine_GetSpec((MachineId_t) i).cpu].push_back(i);
         vector<MachineId_t> temp = {};
         machine_matrix.push_back(temp);
+        machine_vms.push_back({NO_VM, NO_VM, NO_VM, NO_VM});
     }
 
     for(int i = 0; i < machine_by_cpus.size(); i++) {
+        vector<MachineId_t> ids(machine_by_cpus[i].begin(), machine_by_cpus[i].end());
+        vector<bool> gpus;
+        for (MachineId_t id : ids) {
+            gpus.push_back(Machine_GetSpec(id).gpus);
+        }
+        running_capacity.emplace_back();
+        running_capacity[i].Init(ids, gpus);
+        idle_capacity.emplace_back();
+        idle_capacity[i].Init(ids, gpus);
+
         int first_set = ceil((double) machine_by_cpus[i].size() * 0.5);
-        int second_set = ceil((double) machine_by_cpus[i].size() * 1.0);
+        int second_set = ceil((double) machine_by_cpus[i].size() * 0.5);
         for(int j = 0; j < first_set; j++) {
-            running[i].push_back(machine_by_cpus[i][j]);
+            running[i].Add(machine_by_cpus[i][j]);
+            UpdateCapacity(running_capacity[i], machine_by_cpus[i][j], 0);
         } 
         for(int j = first_set; j < second_set; j++) {
             // Machine_SetState(machine_by_cpus[i][j], IDLE_S_STATE);
@@ -191,6 +260,7 @@ void Scheduler::Init() {
             changing_state[machine_by_cpus[i][j]] = {RUNNING_S_STATE, OFF_S_STATE, false, 0};
         }
     }
+    dvfs.Init(total_machines);
 }
 
 //useless because we don't migrate
@@ -198,197 +268,138 @@ void Scheduler::MigrationComplete(Time_t time, VMId_t vm_id) {
     // Update your data structure. The VM now can receive new tasks
 }
 
-void Scheduler::NewTask(Time_t now, TaskId_t task_id) {
-    TaskInfo_t task = GetTaskInfo(task_id);
-    
-    // dev notes: update "running" and "idle" to account for machines
-    //            of diff types and gpu capability
-    CPUType_t task_cpu = task.required_cpu;
-    if(task.gpu_capable) {
-        for (MachineId_t id : running[task_cpu]) {
-            MachineInfo_t machine = Machine_GetInfo(id);
-            if(machine.gpus) {
-                double machine_util = machine_eff_mips(id, now);
-                double task_util = task_eff_mips(task_id, id, now);
-                double machine_max_util = machine.performance[P0] * machine.num_cpus;
-
-                bool correct_cpu = task.required_cpu == machine.cpu;
-                bool enough_mem = machine.memory_used + task.required_memory + 8 < machine.memory_size;
-                bool enough_util = machine_util + task_util <= machine_max_util;
-
-                // dev notes: data struct to keep track of vm by vm_type?
-                // dev notes: is the change_state.count required?
-                if (!changing_state.count(id) && correct_cpu && enough_mem && enough_util) {
-                    FindVMAddTask(id, task_id);
-                    return;
-                }
-            }
-        }
-
-        for (MachineId_t id : idle[task_cpu]) {
-            MachineInfo_t machine = Machine_GetInfo(id);
-            if(machine.gpus) {
-                bool correct_cpu = task.required_cpu == machine.cpu;
-                bool enough_mem = machine.memory_used + task.required_memory + 8 < machine.memory_size;
-
-                // dev notes: state change issues? (if idle is moving around)
-                // dev notes: is the change_state.count required?
-                if (!changing_state.count(id) && correct_cpu && enough_mem) {
-                    // dev notes: state change issues?
-                    Machine_SetCorePerformance(id, 0, RUNNING_P_STATE);
-                    running[task_cpu].push_back(id);
-                    idle[task_cpu].erase(remove(idle[task_cpu].begin(), 
-                            idle[task_cpu].end(), id), idle[task_cpu].end());
-                    FindVMAddTask(id, task_id);
-                    return;
-                }
-            }
-        }
-    }
+// First fit over the running machines
+bool Scheduler::PlaceOnRunning(TaskId_t task_id, const TaskRequirements_t & task, bool need_gpu, Time_t now) {
+    CapacityIndex & index = running_capacity[task.required_cpu];
+    double task_util = task_eff_mips(0, task_id, now);
+    unsigned task_memory = task.required_memory + 8;
 
-    for (MachineId_t id : running[task_cpu]) {
-        MachineInfo_t machine = Machine_GetInfo(id);
+    for (int slot = index.FirstFit(task_util, task_memory, need_gpu); slot >= 0;
+            slot = index.FirstFit(task_util, task_memory, need_gpu, slot + 1)) {
+        MachineId_t id = index.MachineAt(slot);
+        const MachineSpec_t & machine = Machine_GetSpec(id);
+        MachineStatus_t machine_state = Machine_GetStatus(id);
 
         double machine_util = machine_eff_mips(id, now);
-        double task_util = task_eff_mips(task_id, id, now);
         double machine_max_util = machine.performance[P0] * machine.num_cpus;
 
-        bool correct_cpu = task.required_cpu == machine.cpu;
-        bool enough_mem = machine.memory_used + task.required_memory + 8 < machine.memory_size;
+        bool enough_mem = machine_state.memory_used + task_memory < machine.memory_size;
         bool enough_util = machine_util + task_util <= machine_max_util;
 
-        // dev notes: data struct to keep track of vm by vm_type?
-        // dev notes: is the change_state.count required?
-        if (!changing_state.count(id) && correct_cpu && enough_mem && enough_util) {
+        if (!changing_state.count(id) && enough_mem && enough_util) {
             FindVMAddTask(id, task_id);
-            return;
+            UpdateCapacity(index, id, now);
+            return true;
         }
     }
+    return false;
+}
 
-    for (MachineId_t id : idle[task_cpu]) {
-        MachineInfo_t machine = Machine_GetInfo(id);
-
-        bool correct_cpu = task.required_cpu == machine.cpu;
-        bool enough_mem = machine.memory_used + task.required_memory + 8 < machine.memory_size;
-
-        // dev notes: state change issues? (if idle is moving around)
-        // dev notes: is the change_state.count required?
-        if (!changing_state.count(id) && correct_cpu && enough_mem) {
-            // dev notes: state change issues?
-            Machine_SetCorePerformance(id, 0, RUNNING_P_STATE);
+// First fit over the idle machines, the chosen machine becomes running
+bool Scheduler::PlaceOnIdle(TaskId_t task_id, const TaskRequirements_t & task, bool need_gpu, Time_t now) {
+    CPUType_t task_cpu = task.required_cpu;
+    CapacityIndex & index = idle_capacity[task_cpu];
+    unsigned task_memory = task.required_memory + 8;
+
+    for (int slot = index.FirstFit(0, task_memory, need_gpu); slot >= 0;
+            slot = index.FirstFit(0, task_memory, need_gpu, slot + 1)) {
+        MachineId_t id = index.MachineAt(slot);
+        const MachineSpec_t & machine = Machine_GetSpec(id);
+        MachineStatus_t machine_state = Machine_GetStatus(id);
+
+        bool enough_mem = machine_state.memory_used + task_memory < machine.memory_size;
+
+        if (!changing_state.count(id) && enough_mem) {
+            idle[task_cpu].Remove(id);
+            running[task_cpu].Add(id);
+            index.Remove(id);
+            last_active[id] = 0;
             FindVMAddTask(id, task_id);
-            idle[task_cpu].erase(remove(idle[task_cpu].begin(), idle[task_cpu].end(), id), idle[task_cpu].end());
-            running[task_cpu].push_back(id);
-            return;
+            UpdateCapacity(running_capacity[task_cpu], id, now);
+            return true;
         }
+        UpdateCapacity(index, id, now);
     }
+    return false;
+}
+
+// GPU capable tasks go to machines with GPUs first
+bool Scheduler::PlaceTask(TaskId_t task_id, Time_t now) {
+    TaskRequirements_t task = GetTaskRequirements(task_id);
 
-    queue.push_back(task_id);
+    if (task.gpu_capable && (PlaceOnRunning(task_id, task, true, now) || PlaceOnIdle(task_id, task, true, now))) {
+        return true;
+    }
+    return PlaceOnRunning(task_id, task, false, now) || PlaceOnIdle(task_id, task, false, now);
 }
 
-void updateWaitingQueue(Time_t now) {
-    //pop off tasks that are waiting
-    while(queue.size() > 0) {
-        TaskId_t task_id = queue[0];
-        TaskInfo_t task = GetTaskInfo(task_id);
-        CPUType_t task_cpu = task.required_cpu;
-        bool done = false;
-        if(task.gpu_capable) {
-            for (MachineId_t id : running[task_cpu]) {
-                MachineInfo_t machine = Machine_GetInfo(id);
-                if(machine.gpus) {
-                    double machine_util = machine_eff_mips(id, now);
-                    double task_util = task_eff_mips(task_id, id, now);
-                    double machine_max_util = machine.performance[P0] * machine.num_cpus;
-
-                    bool correct_cpu = task.required_cpu == machine.cpu;
-                    bool enough_mem = machine.memory_used + task.required_memory + 8 < machine.memory_size;
-                    bool enough_util = machine_util + task_util <= machine_max_util;
-
-                    // dev notes: data struct to keep track of vm by vm_type?
-                    // dev notes: is the change_state.count required?
-                    if (!changing_state.count(id) && correct_cpu && enough_mem && enough_util) {
-                        FindVMAddTask(id, task_id);
-                        queue.pop_front();
-                        done = true;
-                        break;
-                    }
-                }
+// Rebooks the demand of every task at now and refreshes the headroom of the
+// machines that have tasks. Demand that dropped frees capacity for the tasks
+// waiting on that cpu type.
+void Scheduler::RebookDemand(Time_t now) {
+    for (unsigned i = 0; i < running.size(); i++) {
+        for (MachineId_t id : running[i]) {
+            booked_mips[id] = ledger.MachineDemand(id);
+        }
+        for (MachineId_t id : idle[i]) {
+            booked_mips[id] = ledger.MachineDemand(id);
+        }
+    }
+    ledger.Rebook(now);
+    for (unsigned i = 0; i < running.size(); i++) {
+        for (MachineId_t id : running[i]) {
+            if (ledger.MachineDemand(id) < booked_mips[id]) {
+                cpu_freed[i] = true;
             }
-
-            for (MachineId_t id : idle[task_cpu]) {
-                MachineInfo_t machine = Machine_GetInfo(id);
-                if(machine.gpus) {
-                    bool correct_cpu = task.required_cpu == machine.cpu;
-                    bool enough_mem = machine.memory_used + task.required_memory + 8 < machine.memory_size;
-
-                    // dev notes: state change issues? (if idle is moving around)
-                    // dev notes: is the change_state.count required?
-                    if (!changing_state.count(id) && correct_cpu && enough_mem) {
-                        // dev notes: state change issues?
-                        Machine_SetCorePerformance(id, 0, RUNNING_P_STATE);
-                        idle[task_cpu].erase(remove(idle[task_cpu].begin(), idle[task_cpu].end(), id), idle[task_cpu].end());
-                        running[task_cpu].push_back(id);
-                        last_active[id] = 0;
-                        FindVMAddTask(id, task_id);
-                        queue.pop_front();
-                        done = true;
-                        break;
-                    }
-                }
+            if (running_capacity[i].Contains(id)) {
+                UpdateCapacity(running_capacity[i], id, now);
             }
-            if(done) {
-                continue;
+        }
+        for (MachineId_t id : idle[i]) {
+            if (ledger.MachineDemand(id) != booked_mips[id] && idle_capacity[i].Contains(id)) {
+                UpdateCapacity(idle_capacity[i], id, now);
             }
         }
+    }
+}
 
-        for (MachineId_t id : running[task_cpu]) {
-            MachineInfo_t machine = Machine_GetInfo(id);
-
-            double machine_util = machine_eff_mips(id, now);
-            double task_util = task_eff_mips(task_id, id, now);
-            double machine_max_util = machine.performance[P0] * machine.num_cpus;
+void Scheduler::WaitForCapacity(TaskId_t task_id) {
+    CPUType_t cpu = RequiredCPUType(task_id);
+    wait_shards[shard_of(cpu, IsTaskGPUCapable(task_id), RequiredSLA(task_id))].push_back(task_id);
+    wait_targets[cpu].push({GetTaskTargetCompletion(task_id), task_id});
+    waiting_tasks.insert(task_id);
+}
 
-            bool correct_cpu = task.required_cpu == machine.cpu;
-            bool enough_mem = machine.memory_used + task.required_memory + 8 < machine.memory_size;
-            bool enough_util = machine_util + task_util <= machine_max_util;
+void Scheduler::NewTask(Time_t now, TaskId_t task_id) {
+    if (!PlaceTask(task_id, now)) {
+        WaitForCapacity(task_id);
+    }
+}
 
-            // dev notes: data struct to keep track of vm by vm_type?
-            // dev notes: is the change_state.count required?
-            if (!changing_state.count(id) && correct_cpu && enough_mem && enough_util) {
-                FindVMAddTask(id, task_id);
-                queue.pop_front();
-                done = true;
-                break;
+void Scheduler::updateWaitingQueue(Time_t now) {
+    for (unsigned cpu = 0; cpu < cpu_freed.size(); cpu++) {
+        // a task past its target asks for next to no mips, so that frees capacity for it too
+        while (wait_targets[cpu].size() > 0 && wait_targets[cpu].top().first <= now) {
+            if (waiting_tasks.count(wait_targets[cpu].top().second)) {
+                cpu_freed[cpu] = true;
             }
+            wait_targets[cpu].pop();
         }
-        if(done) {
+        if (!cpu_freed[cpu]) {
             continue;
         }
-
-        for (MachineId_t id : idle[task_cpu]) {
-            MachineInfo_t machine = Machine_GetInfo(id);
-
-            bool correct_cpu = task.required_cpu == machine.cpu;
-            bool enough_mem = machine.memory_used + task.required_memory + 8 < machine.memory_size;
-
-            // dev notes: state change issues? (if idle is moving around)
-            // dev notes: is the change_state.count required?
-            if (!changing_state.count(id) && correct_cpu && enough_mem) {
-                // dev notes: state change issues?
-                idle[task_cpu].erase(remove(idle[task_cpu].begin(), idle[task_cpu].end(), id), idle[task_cpu].end());
-                running[task_cpu].push_back(id);
-                Machine_SetCorePerformance(id, 0, IDLE_P_STATE);
-                FindVMAddTask(id, task_id);
-                queue.pop_front();
-                done = true;
-                break;
+        cpu_freed[cpu] = false;
+
+        //pop off tasks that are waiting, most urgent sla first
+        for (unsigned sla = 0; sla < NUM_SLAS; sla++) {
+            for (int gpu_capable = 1; gpu_capable >= 0; gpu_capable--) {
+                deque<TaskId_t> & shard = wait_shards[shard_of(CPUType_t(cpu), gpu_capable, SLAType_t(sla))];
+                while (shard.size() > 0 && PlaceTask(shard.front(), now)) {
+                    waiting_tasks.erase(shard.front());
+                    shard.pop_front();
+                }
             }
         }
-        if(done) {
-            continue;
-        }
-        break;
     }
 }
 
@@ -399,9 +410,30 @@ void Scheduler::PeriodicCheck(Time_t now) {
     // Recommendation: Take advantage of this function to do some monitoring and adjustments as necessary
     // about 1 sec between checks
     
+    // the simulator just advanced the tasks, so their rates are due again
+    RebookDemand(now);
+#ifdef DEBUG
+    ledger.Check(now);
+#endif
+
     if(now - wait_queue_time >= SECOND / 10) {
         wait_queue_time = now;
         updateWaitingQueue(now);
+        dvfs.Refresh(now);
+
+        // tasks still waiting are demand the running machines could not take
+        vector<double> demand(forecasts.size(), 0.0);
+        for (unsigned shard = 0; shard < wait_shards.size(); shard++) {
+            for (TaskId_t task_id : wait_shards[shard]) {
+                demand[shard / (2 * NUM_SLAS)] += task_eff_mips(0, task_id, now);
+            }
+        }
+        for (unsigned i = 0; i < forecasts.size(); i++) {
+            for (MachineId_t id : running[i]) {
+                demand[i] += machine_eff_mips(id, now);
+            }
+            forecasts[i].Observe(now, demand[i]);
+        }
     }
 
     if(now - last_time >= SECOND) {
@@ -412,20 +444,23 @@ void Scheduler::PeriodicCheck(Time_t now) {
                 unsigned cpu_max_mips = 0;
                 
                 for (MachineId_t id : running[i]) {
-                    MachineInfo_t info = Machine_GetInfo(id);
+                    const MachineSpec_t & info = Machine_GetSpec(id);
                     cpu_total_mips += machine_eff_mips(id, now);
                     cpu_max_mips += info.performance[P0] * info.num_cpus;
                 }
 
                 for (MachineId_t id : idle[i]) {
-                    MachineInfo_t info = Machine_GetInfo(id);
+                    const MachineSpec_t & info = Machine_GetSpec(id);
                     cpu_max_mips += info.performance[P0] * info.num_cpus;
                 }
                 
                 double cpu_util = cpu_max_mips == 0 ? 0 : (double) cpu_total_mips / (double) cpu_max_mips;
+                // demand expected by the time a machine woken now is up
+                double expected_mips = forecasts[i].Forecast(wake_latency[OFF_S_STATE] + SECOND);
+                double expected_util = cpu_max_mips == 0 ? 0 : expected_mips / cpu_max_mips;
 
-                if (cpu_util > 0.5) {
-                    double theoretical_util = cpu_util;
+                if (max(cpu_util, expected_util) > 0.5) {
+                    double theoretical_util = max(cpu_util, expected_util);
                     
                     unsigned idle_index = 0;
                     while (idle_index < off[i].size() && theoretical_util > 0.5) {
@@ -433,10 +468,11 @@ void Scheduler::PeriodicCheck(Time_t now) {
                         if(!changing_state.count(id)) {
                             Machine_SetState(id, RUNNING_S_STATE);
                             changing_state[id] = {OFF_S_STATE, RUNNING_S_STATE, false, 0};
+                            wake_started[id] = now;
                             
-                            MachineInfo_t info = Machine_GetInfo(id);
+                            const MachineSpec_t & info = Machine_GetSpec(id);
                             cpu_max_mips += info.performance[P0] * info.num_cpus;
-                            theoretical_util = cpu_max_mips == 0 ? 0 : cpu_total_mips / cpu_max_mips;
+                            theoretical_util = cpu_max_mips == 0 ? 0 : max((double) cpu_total_mips, expected_mips) / cpu_max_mips;
                         }
                         idle_index++;
                     }
@@ -457,6 +493,16 @@ void Scheduler::PeriodicCheck(Time_t now) {
     }
 }
 
+void Scheduler::Sample(TelemetrySample_t & sample) {
+    for (MachineId_t id = 0; id < (MachineId_t) total_machines; id++) {
+        sample.cpus[Machine_GetSpec(id).cpu].demand_mips += ledger.MachineDemand(id);
+    }
+    for (const deque<TaskId_t> & shard : wait_shards) {
+        sample.waiting += shard.size();
+    }
+    sample.state_changes = changing_state.size();
+}
+
 void Scheduler::Shutdown(Time_t time) {
     // Do your final reporting and bookkeeping here.
     // Report about the total energy consumed
@@ -465,8 +511,8 @@ void Scheduler::Shutdown(Time_t time) {
     for(auto & vm: vms) {
         VM_Shutdown(vm);
     }
-    SimOutput("SimulationComplete(): Finished!", 4);
-    SimOutput("SimulationComplete(): Time is " + to_string(time), 4);
+    SIM_LOG(4, "SimulationComplete(): Finished!");
+    SIM_LOG(4, "SimulationComplete(): Time is ", time);
 }
 
 void Scheduler::TaskComplete(Time_t now, TaskId_t task_id) {
@@ -476,76 +522,29 @@ void Scheduler::TaskComplete(Time_t now, TaskId_t task_id) {
     VMId_t old_vm = task_to_vm[task_id];
     MachineId_t curr_machine = VM_GetInfo(old_vm).machine_id;
     task_to_vm.erase(task_id);
-    CPUType_t machine_cpu = Machine_GetInfo(curr_machine).cpu;
+    ledger.RemoveTask(task_id);
+    dvfs.RemoveTask(task_id, now);
+    CPUType_t machine_cpu = Machine_GetSpec(curr_machine).cpu;
+    cpu_freed[machine_cpu] = true;
     if(machine_eff_mips(curr_machine, now) == 0.0) {
-        running[machine_cpu].erase(remove(running[machine_cpu].begin(), running[machine_cpu].end(), curr_machine), running[machine_cpu].end());
-        idle[machine_cpu].push_back(curr_machine);
+        running[machine_cpu].Remove(curr_machine);
+        idle[machine_cpu].Add(curr_machine);
+        running_capacity[machine_cpu].Remove(curr_machine);
+        UpdateCapacity(idle_capacity[machine_cpu], curr_machine, now);
         // if(vm_eff_mips(curr_machine, old_vm, now) == 0.0) {            
         //     machine_matrix[curr_machine].erase(remove(machine_matrix[curr_machine].begin(), 
         //                         machine_matrix[curr_machine].end(), old_vm), machine_matrix[curr_machine].end());
             
         //     VM_Shutdown(old_vm);
         // }
-        Machine_SetCorePerformance(curr_machine, 0, IDLE_P_STATE);
         // last_active[idle[machine_cpu][curr_machine]] = now;
+    } else if (running_capacity[machine_cpu].Contains(curr_machine)) {
+        UpdateCapacity(running_capacity[machine_cpu], curr_machine, now);
     }
-    SimOutput("Scheduler::TaskComplete(): Task " + to_string(task_id) + " is complete at " + to_string(now), 4);
+    SIM_LOG(4, "Scheduler::TaskComplete(): Task ", task_id, " is complete at ", now);
 }
 
-// Public interface below
-
-static Scheduler Scheduler;
-
-void InitScheduler() {
-    SimOutput("InitScheduler(): Initializing scheduler", 4);
-    Scheduler.Init();
-}
-
-void HandleNewTask(Time_t time, TaskId_t task_id) {
-    SimOutput("HandleNewTask(): Received new task " + to_string(task_id) + " at time " + to_string(time), 4);
-    Scheduler.NewTask(time, task_id);
-}
-
-void HandleTaskCompletion(Time_t time, TaskId_t task_id) {
-    SimOutput("HandleTaskCompletion(): Task " + to_string(task_id) + " completed at time " + to_string(time), 4);
-    Scheduler.TaskComplete(time, task_id);
-}
-
-void MemoryWarning(Time_t time, MachineId_t machine_id) {
-    // The simulator is alerting you that machine identified by machine_id is overcommitted
-    SimOutput("MemoryWarning(): Overflow at " + to_string(machine_id) + " was detected at time " + to_string(time), 0);
-}
-
-void MigrationDone(Time_t time, VMId_t vm_id) {
-    // The function is called on to alert you that migration is complete
-    SimOutput("MigrationDone(): Migration of VM " + to_string(vm_id) + " was completed at time " + to_string(time), 4);
-    Scheduler.MigrationComplete(time, vm_id);
-}
-
-void SchedulerCheck(Time_t time) {
-    // This function is called periodically by the simulator, no specific event
-    SimOutput("SchedulerCheck(): SchedulerCheck() called at " + to_string(time), 4);
-    Scheduler.PeriodicCheck(time);
-}
-
-void SimulationComplete(Time_t time) {
-    // This function is called before the simulation terminates Add whatever you feel like.
-    cout << "SLA violation report" << endl;
-    cout << "SLA0: " << GetSLAReport(SLA0) << "%" << endl;
-    cout << "SLA1: " << GetSLAReport(SLA1) << "%" << endl;
-    cout << "SLA2: " << GetSLAReport(SLA2) << "%" << endl;     // SLA3 do not have SLA violation issues
-    cout << "Total Energy " << Machine_GetClusterEnergy() << "KW-Hour" << endl;
-    cout << "Simulation run finished in " << double(time)/1000000 << " seconds" << endl;
-    SimOutput("SimulationComplete(): Simulation finished at time " + to_string(time), 4);
-    
-    Scheduler.Shutdown(time);
-}
-
-void SLAWarning(Time_t time, TaskId_t task_id) {
-    
-}
-
-void StateChangeComplete(Time_t time, MachineId_t machine_id) {
+void Scheduler::StateChangeComplete(Time_t time, MachineId_t machine_id) {
     stateChangeInfo info = changing_state[machine_id];
     
     // // either idle machine or off machine woken for task assignment
@@ -553,26 +552,44 @@ void StateChangeComplete(Time_t time, MachineId_t machine_id) {
     //     FindVMAddTask(machine_id, info.task);
     // }
 
-    CPUType_t machine_cpu = Machine_GetInfo(machine_id).cpu;
+    CPUType_t machine_cpu = Machine_GetSpec(machine_id).cpu;
     // dev notes: state change issues?
     // idle->off
     if (info.old_state == RUNNING_S_STATE) {
-        idle[machine_cpu].erase(remove(idle[machine_cpu].begin(), idle[machine_cpu].end(), machine_id), idle[machine_cpu].end());
+        idle[machine_cpu].Remove(machine_id);
+        idle_capacity[machine_cpu].Remove(machine_id);
     } 
     //off->idle
     else if (info.old_state == OFF_S_STATE) {
-        off[machine_cpu].erase(remove(off[machine_cpu].begin(), off[machine_cpu].end(), machine_id), off[machine_cpu].end());
+        off[machine_cpu].Remove(machine_id);
     }
 
     // dev notes: state change issues?
     //off->idle
     if (info.new_state == RUNNING_S_STATE) {
-       idle[machine_cpu].push_back(machine_id);
+       idle[machine_cpu].Add(machine_id);
+       UpdateCapacity(idle_capacity[machine_cpu], machine_id, time);
+       cpu_freed[machine_cpu] = true;
+       auto woken = wake_started.find(machine_id);
+       if (woken != wake_started.end()) {
+           Time_t latency = time - woken->second;
+           Time_t & estimate = wake_latency[info.old_state];
+           estimate = (3 * estimate + latency) / 4;
+           wake_started.erase(woken);
+       }
     } 
     //idle->off
     else if (info.new_state == OFF_S_STATE) {
-        off[machine_cpu].push_back(machine_id);
+        off[machine_cpu].Add(machine_id);
     }
 
     changing_state.erase(machine_id);
-}
\ No newline at end of file
+}
+
+SchedulerPolicy * Create() {
+    return new Scheduler();
+}
+
+static bool registered = Scheduler_Register("default", Create);
+
+} // namespace default_policy
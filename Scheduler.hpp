@@ -8,24 +8,34 @@
 #ifndef Scheduler_hpp
 #define Scheduler_hpp
 
+#include <string>
 #include <vector>
 
 #include "Interfaces.h"
+#include "Telemetry.h"
 
-class Scheduler {
+// A scheduling algorithm. Each Scheduler_*.cpp defines one in its own namespace
+// and registers it by name; SIM_SCHEDULER=<name> picks the one the public
+// scheduler interface dispatches to (Scheduler.cpp's "default" otherwise).
+class SchedulerPolicy {
 public:
-    Scheduler()                 {}
-    void Init();
-    void MigrationComplete(Time_t time, VMId_t vm_id);
-    void NewTask(Time_t now, TaskId_t task_id);
-    void PeriodicCheck(Time_t now);
-    void Shutdown(Time_t now);
-    void TaskComplete(Time_t now, TaskId_t task_id);
-private:
-    vector<VMId_t> vms;
-    vector<MachineId_t> machines;
+    virtual ~SchedulerPolicy()  {}
+    virtual void Init() = 0;
+    virtual void MemoryWarning(Time_t time, MachineId_t machine_id)         {}
+    virtual void MigrationComplete(Time_t time, VMId_t vm_id) = 0;
+    virtual void NewTask(Time_t now, TaskId_t task_id) = 0;
+    virtual void PeriodicCheck(Time_t now) = 0;
+    virtual void Sample(TelemetrySample_t & sample)                         {}  // Demand, queue and state change figures
+    virtual void Shutdown(Time_t now) = 0;
+    virtual void SLAWarning(Time_t time, TaskId_t task_id)                  {}
+    virtual void StateChangeComplete(Time_t time, MachineId_t machine_id) = 0;
+    virtual void TaskComplete(Time_t now, TaskId_t task_id) = 0;
 };
 
+typedef SchedulerPolicy * (*SchedulerFactory_t)();
 
+// Returns true so that the result can initialize a static in the policy's file
+extern bool             Scheduler_Register(string name, SchedulerFactory_t factory);
+extern vector<string>   Scheduler_Names();
 
-#endif /* Scheduler_hpp */
\ No newline at end of file
+#endif /* Scheduler_hpp */
@@ -0,0 +1,127 @@
+//
+//  SchedulerRegistry.cpp
+//  CloudSim
+//
+//  Name -> policy table filled in by the Scheduler_*.cpp files at static
+//  initialization, and the public scheduler interface, which forwards to the
+//  policy selected with SIM_SCHEDULER.
+//
+
+#include "Scheduler.hpp"
+#include "Internal_Interfaces.h"
+#include "Log.h"
+#include "Profile.h"
+#include "Telemetry.h"
+
+#include <cstdlib>
+#include <map>
+
+// Function-local so that it exists before any policy file registers into it
+static map<string, SchedulerFactory_t> & Registry() {
+    static map<string, SchedulerFactory_t> registry;
+    return registry;
+}
+
+bool Scheduler_Register(string name, SchedulerFactory_t factory) {
+    Registry()[name] = factory;
+    return true;
+}
+
+vector<string> Scheduler_Names() {
+    vector<string> names;
+    for (auto & [name, factory] : Registry()) {
+        names.push_back(name);
+    }
+    return names;
+}
+
+// Public interface below
+
+static SchedulerPolicy * Scheduler = nullptr;
+
+void InitScheduler() {
+    // The scheduler side caches live at file scope, so a new run resets them
+    // before anything reads them
+    Log_Reset();
+    TaskView_Reset();
+    VMView_Reset();
+    SIM_LOG(4, "InitScheduler(): Initializing scheduler");
+    Profile_Init();
+    Telemetry_Init();
+    const char * name = getenv("SIM_SCHEDULER");
+    string policy = name != nullptr && *name != '\0' ? name : "default";
+    auto it = Registry().find(policy);
+    if (it == Registry().end()) {
+        string known;
+        for (const string & n : Scheduler_Names()) {
+            known += " " + n;
+        }
+        ThrowException("InitScheduler(): Unknown scheduler " + policy + ", choose one of:", known);
+    }
+    // A policy keeps all of its state in the instance, so a new run starts clean
+    delete Scheduler;
+    Scheduler = it->second();
+    Scheduler->Init();
+}
+
+void HandleNewTask(Time_t time, TaskId_t task_id) {
+    ProfileScope profile(PROFILE_NEW_TASK);
+    SIM_LOG(4, "HandleNewTask(): Received new task ", task_id, " at time ", time);
+    Scheduler->NewTask(time, task_id);
+}
+
+void HandleTaskCompletion(Time_t time, TaskId_t task_id) {
+    ProfileScope profile(PROFILE_TASK_COMPLETION);
+    SIM_LOG(4, "HandleTaskCompletion(): Task ", task_id, " completed at time ", time);
+    Scheduler->TaskComplete(time, task_id);
+}
+
+void MemoryWarning(Time_t time, MachineId_t machine_id) {
+    ProfileScope profile(PROFILE_MEMORY_WARNING);
+    // The simulator is alerting you that machine identified by machine_id is overcommitted
+    SIM_LOG(0, "MemoryWarning(): Overflow at ", machine_id, " was detected at time ", time);
+    Scheduler->MemoryWarning(time, machine_id);
+}
+
+void MigrationDone(Time_t time, VMId_t vm_id) {
+    ProfileScope profile(PROFILE_MIGRATION_DONE);
+    // The function is called on to alert you that migration is complete
+    SIM_LOG(4, "MigrationDone(): Migration of VM ", vm_id, " was completed at time ", time);
+    Scheduler->MigrationComplete(time, vm_id);
+}
+
+void SchedulerCheck(Time_t time) {
+    ProfileScope profile(PROFILE_SCHEDULER_CHECK);
+    // This function is called periodically by the simulator, no specific event
+    SIM_LOG(4, "SchedulerCheck(): SchedulerCheck() called at ", time);
+    Scheduler->PeriodicCheck(time);
+    if (Telemetry_Due(time)) {
+        Scheduler->Sample(Telemetry_Begin(time));
+    }
+}
+
+void SimulationComplete(Time_t time) {
+    // This function is called before the simulation terminates Add whatever you feel like.
+    cout << "SLA violation report" << endl;
+    cout << "SLA0: " << GetSLAReport(SLA0) << "%" << endl;
+    cout << "SLA1: " << GetSLAReport(SLA1) << "%" << endl;
+    cout << "SLA2: " << GetSLAReport(SLA2) << "%" << endl;     // SLA3 do not have SLA violation issues
+    cout << "Total Energy " << Machine_GetClusterEnergy() << "KW-Hour" << endl;
+    cout << "Simulation run finished in " << double(time)/1000000 << " seconds" << endl;
+    SIM_LOG(4, "SimulationComplete(): Simulation finished at time ", time);
+    Profile_Report(time);
+    
+    Scheduler->Shutdown(time);
+    Telemetry_Flush();
+    Log_Flush();
+}
+
+void SLAWarning(Time_t time, TaskId_t task_id) {
+    ProfileScope profile(PROFILE_SLA_WARNING);
+    Scheduler->SLAWarning(time, task_id);
+}
+
+void StateChangeComplete(Time_t time, MachineId_t machine_id) {
+    ProfileScope profile(PROFILE_STATE_CHANGE);
+    Scheduler->StateChangeComplete(time, machine_id);
+}
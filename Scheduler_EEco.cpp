@@ -6,8 +6,12 @@
 // EEco
 
 #include "Scheduler.hpp"
+#include "DemandLedger.hpp"
+#include "Log.h"
+#include "MachinePool.hpp"
 
 #include <algorithm>
+#include <array>
 #include <cmath>
 #include <unordered_map>
 #include <unordered_set>
@@ -15,65 +19,98 @@
 #include <math.h>
 #include <deque>
 
-// Managing machines
-vector<vector<MachineId_t>> machine_matrix;
+namespace eeco_policy {
 
-unsigned total_machines;
+// Reusable vm per machine and vm type, NO_VM until one is opened
+const VMId_t NO_VM = VMId_t(-1);
 
-// Current mips of task
-double task_eff_mips(MachineId_t machine_id, TaskId_t task_id, Time_t curr) {
-    TaskInfo_t info = GetTaskInfo(task_id);
+const MachineState_t RUNNING_S_STATE = S0;
+const MachineState_t IDLE_S_STATE = S1;
+const MachineState_t OFF_S_STATE = S2;
+
+struct stateChangeInfo {
+    MachineState_t old_state;
+    MachineState_t new_state;
+    bool attach_task;
+    TaskId_t task;
+};
+
+// For Idle set adjustment
+const uint64_t SECOND = 1000000;
+
+class Scheduler : public SchedulerPolicy {
+public:
+    Scheduler()                 {}
+    void Init();
+    void MigrationComplete(Time_t time, VMId_t vm_id);
+    void NewTask(Time_t now, TaskId_t task_id);
+    void PeriodicCheck(Time_t now);
+    void Sample(TelemetrySample_t & sample);
+    void Shutdown(Time_t now);
+    void StateChangeComplete(Time_t time, MachineId_t machine_id);
+    void TaskComplete(Time_t now, TaskId_t task_id);
+private:
+    vector<VMId_t> vms;
+    vector<MachineId_t> machines;
+
+    void FindVMAddTask(MachineId_t id, TaskId_t task_id);
+    double machine_eff_mips(MachineId_t machine_id, Time_t curr);
+    void updateWaitingQueue(Time_t now);
+    unsigned vm_eff_mips(MachineId_t machine_id, VMId_t vm_id, Time_t curr);
+
+    // Managing machines
+    vector<vector<MachineId_t>> machine_matrix;
+    vector<array<VMId_t, NUM_VM_TYPES>> machine_vms;
+
+    unsigned total_machines = 0;
+
+    // Booked mips per task, vm and machine
+    DemandLedger ledger;
+
+    // Managing states
+    vector<MachinePool> running;
+    vector<MachinePool> idle;
+    vector<MachinePool> off;
+
+    unordered_map<unsigned, stateChangeInfo> idle_adjust_set;
+    unordered_map<unsigned, stateChangeInfo> changing_state;
+    unsigned desired_idle_set_size = 0;
+
+    uint64_t last_time = 0;
+    uint64_t wait_queue_time = 0;
+
+    deque<unsigned> queue;
+
+    vector<vector<uint64_t>> machine_by_cpus;
+};
 
+// Mips a task needs at curr, the demand the ledger books
+double task_demand(uint64_t remaining_instr, uint64_t total_instr, Time_t target, Time_t curr) {
     // somehow, remaining_instr is subject to unsigned integer overflow
-    if (info.remaining_instructions > info.total_instructions) {
+    if (remaining_instr > total_instr) {
         return 0;
     }
 
-    uint64_t remaining_instr = info.remaining_instructions;
-    uint64_t time_frame = info.target_completion - curr;
+    uint64_t time_frame = target - curr;
 
     double eff_mips = (double) remaining_instr / (double) time_frame;
 
 	return eff_mips;
 }
 
-// Current mips of vm
-unsigned vm_eff_mips(MachineId_t machine_id, VMId_t vm_id, Time_t curr) {
-    unsigned eff_mips = 0;
-
-    for (TaskId_t task_id : VM_GetInfo(vm_id).active_tasks) {
-        TaskInfo_t info = GetTaskInfo(task_id);
-
-        uint64_t remaining_instr = info.remaining_instructions;
-        uint64_t time_frame = info.target_completion - curr;
-
-        eff_mips += remaining_instr / time_frame;
-    }
-    
-	return eff_mips;
+// Current mips of task
+double task_eff_mips(MachineId_t machine_id, TaskId_t task_id, Time_t curr) {
+    return task_demand(GetTaskRemainingInstructions(task_id), GetTaskTotalInstructions(task_id), GetTaskTargetCompletion(task_id), curr);
 }
 
-// Current mips of machine
-double machine_eff_mips(MachineId_t machine_id, Time_t curr) {
-    double eff_mips = 0.0;
-
-    for (VMId_t vm_id : machine_matrix[machine_id]) {
-        for (TaskId_t task_id : VM_GetInfo(vm_id).active_tasks) {
-            TaskInfo_t info = GetTaskInfo(task_id);
-
-            uint64_t remaining_instr = info.remaining_instructions;
-            uint64_t time_frame = info.target_completion - curr;
-
-            // somehow, remaining_instr is subject to unsigned integer overflow
-            if (remaining_instr > info.total_instructions) {
-                continue;
-            }
+// Booked mips of vm
+unsigned Scheduler::vm_eff_mips(MachineId_t machine_id, VMId_t vm_id, Time_t curr) {
+	return ledger.VMDemand(vm_id);
+}
 
-            eff_mips += (double) remaining_instr / (double) time_frame;
-        }
-    }
-    
-    return eff_mips;
+// Booked mips of machine, the sum of task_eff_mips of its tasks
+double Scheduler::machine_eff_mips(MachineId_t machine_id, Time_t curr) {
+    return ledger.MachineDemand(machine_id);
 }
 
 // Converts SLA to Priority
@@ -84,57 +121,25 @@ Priority_t sla_to_prio(SLAType_t sla) {
     return LOW_PRIORITY;
 }
 
-// Managing states
-vector<vector<uint64_t>> running;
-vector<vector<uint64_t>> idle;
-vector<vector<uint64_t>> off;
-
-const MachineState_t RUNNING_S_STATE = S0;
-const MachineState_t IDLE_S_STATE = S1;
-const MachineState_t OFF_S_STATE = S2;
-
-struct stateChangeInfo {
-    MachineState_t old_state;
-    MachineState_t new_state;
-    bool attach_task;
-    TaskId_t task;
-};
-
-unordered_map<unsigned, stateChangeInfo> idle_adjust_set;
-unordered_map<unsigned, stateChangeInfo> changing_state;
-
-// For Idle set adjustment
-const uint64_t SECOND = 1000000;
-unsigned desired_idle_set_size;
-
-uint64_t last_time = 0;
-uint64_t wait_queue_time = 0;
-
-deque<unsigned> queue;
-
-vector<vector<uint64_t>> machine_by_cpus;
-
 // Find suitable VM (or create one) on Machine for Task
-void FindVMAddTask(MachineId_t id, TaskId_t task_id) {
-    MachineInfo_t machine = Machine_GetInfo(id);
-    TaskInfo_t task = GetTaskInfo(task_id);
-
-    for (VMId_t vm : machine_matrix[id]) {
-        if (task.required_vm == VM_GetInfo(vm).vm_type) {
-            VM_AddTask(vm, task_id, sla_to_prio(task.required_sla));
-            return;
-        }
+void Scheduler::FindVMAddTask(MachineId_t id, TaskId_t task_id) {
+    const MachineSpec_t & machine = Machine_GetSpec(id);
+    VMType_t required_vm = RequiredVMType(task_id);
+    Priority_t priority = sla_to_prio(RequiredSLA(task_id));
+
+    // Tasks of the same vm type share one vm per machine; open it on first use
+    VMId_t & vm = machine_vms[id][required_vm];
+    if (vm == NO_VM) {
+        vm = VM_Create(required_vm, machine.cpu);
+        VM_Attach(vm, id);
+        machine_matrix[id].push_back(vm);
     }
 
-    VMId_t new_vm = VM_Create(task.required_vm, machine.cpu);
-    VM_Attach(new_vm, id);
-    machine_matrix[id].push_back(new_vm);
-
-    VM_AddTask(new_vm, task_id, sla_to_prio(task.required_sla));
+    VM_AddTask(vm, task_id, priority);
+    ledger.AddTask(task_id, vm, id, Now());
     return;
 }
 
-
 void Scheduler::Init() {
     // Find the parameters of the clusters
     // Get the total number of machines
@@ -145,30 +150,29 @@ void Scheduler::Init() {
     //      Get if there is a GPU or not
     
     total_machines = Machine_GetTotal();
+    ledger.Init(total_machines, task_demand);
 
     // we have four cpus
     for(int i = 0 ; i < 4; i++) {
         vector<uint64_t> temp = {};
         machine_by_cpus.push_back(temp);
-        vector<uint64_t> temp2 = {};
-        running.push_back(temp2);
-        vector<uint64_t> temp3 = {};
-        idle.push_back(temp3);        
-        vector<uint64_t> temp4 = {};
-        off.push_back(temp4);
+        running.push_back(MachinePool());
+        idle.push_back(MachinePool());
+        off.push_back(MachinePool());
     }
     
     for(int i = 0; i < total_machines; i++) {
-        machine_by_cpus[Machine_GetInfo((MachineId_t) i).cpu].push_back(i);
+        machine_by_cpus[Machine_GetSpec((MachineId_t) i).cpu].push_back(i);
         vector<MachineId_t> temp = {};
         machine_matrix.push_back(temp);
+        machine_vms.push_back({NO_VM, NO_VM, NO_VM, NO_VM});
     }
 
     for(int i = 0; i < machine_by_cpus.size(); i++) {
         int first_set = ceil((double) machine_by_cpus[i].size() * 0.5);
         int second_set = ceil((double) machine_by_cpus[i].size() * 0.7);
         for(int j = 0; j < first_set; j++) {
-            running[i].push_back(machine_by_cpus[i][j]);
+            running[i].Add(machine_by_cpus[i][j]);
         } 
         for(int j = first_set; j < second_set; j++) {
             Machine_SetState(machine_by_cpus[i][j], IDLE_S_STATE);
@@ -187,20 +191,21 @@ void Scheduler::MigrationComplete(Time_t time, VMId_t vm_id) {
 }
 
 void Scheduler::NewTask(Time_t now, TaskId_t task_id) {
-    TaskInfo_t task = GetTaskInfo(task_id);
+    TaskRequirements_t task = GetTaskRequirements(task_id);
     
     // dev notes: update "running" and "idle" to account for machines
     //            of diff types and gpu capability
     CPUType_t task_cpu = task.required_cpu;
     for (MachineId_t id : running[task_cpu]) {
-        MachineInfo_t machine = Machine_GetInfo(id);
+        const MachineSpec_t & machine = Machine_GetSpec(id);
+        MachineStatus_t machine_state = Machine_GetStatus(id);
 
         double machine_util = machine_eff_mips(id, now);
         double task_util = task_eff_mips(task_id, id, now);
-        double machine_max_util = machine.performance[machine.p_state] * machine.num_cpus;
+        double machine_max_util = machine.performance[machine_state.p_state] * machine.num_cpus;
 
         bool correct_cpu = task.required_cpu == machine.cpu;
-        bool enough_mem = machine.memory_used + task.required_memory + 8 < machine.memory_size;
+        bool enough_mem = machine_state.memory_used + task.required_memory + 8 < machine.memory_size;
         bool enough_util = machine_util + task_util <= machine_max_util;
 
         // dev notes: data struct to keep track of vm by vm_type?
@@ -212,10 +217,11 @@ void Scheduler::NewTask(Time_t now, TaskId_t task_id) {
     }
 
     for (MachineId_t id : idle[task_cpu]) {
-        MachineInfo_t machine = Machine_GetInfo(id);
+        const MachineSpec_t & machine = Machine_GetSpec(id);
+        MachineStatus_t machine_state = Machine_GetStatus(id);
 
         bool correct_cpu = task.required_cpu == machine.cpu;
-        bool enough_mem = machine.memory_used + task.required_memory + 8 < machine.memory_size;
+        bool enough_mem = machine_state.memory_used + task.required_memory + 8 < machine.memory_size;
 
         // dev notes: state change issues? (if idle is moving around)
         // dev notes: is the change_state.count required?
@@ -228,10 +234,11 @@ void Scheduler::NewTask(Time_t now, TaskId_t task_id) {
     }
 
     for (MachineId_t id : off[task_cpu]) {
-        MachineInfo_t machine = Machine_GetInfo(id);
+        const MachineSpec_t & machine = Machine_GetSpec(id);
+        MachineStatus_t machine_state = Machine_GetStatus(id);
 
         bool correct_cpu = task.required_cpu == machine.cpu;
-        bool enough_mem = machine.memory_used + task.required_memory + 8 < machine.memory_size;
+        bool enough_mem = machine_state.memory_used + task.required_memory + 8 < machine.memory_size;
 
         // dev notes: state change issues? (if idle is moving around)
         // dev notes: is the change_state.count required?
@@ -246,22 +253,23 @@ void Scheduler::NewTask(Time_t now, TaskId_t task_id) {
     queue.push_back(task_id);
 }
 
-void updateWaitingQueue(Time_t now) {
+void Scheduler::updateWaitingQueue(Time_t now) {
     //pop off tasks that are waiting
     while(queue.size() > 0) {
         TaskId_t task_id = queue[0];
-        TaskInfo_t task = GetTaskInfo(task_id);
+        TaskRequirements_t task = GetTaskRequirements(task_id);
         CPUType_t task_cpu = task.required_cpu;
         bool done = false;
         for (MachineId_t id : running[task_cpu]) {
-            MachineInfo_t machine = Machine_GetInfo(id);
+            const MachineSpec_t & machine = Machine_GetSpec(id);
+            MachineStatus_t machine_state = Machine_GetStatus(id);
 
             double machine_util = machine_eff_mips(id, now);
             double task_util = task_eff_mips(task_id, id, now);
-            double machine_max_util = machine.performance[machine.p_state] * machine.num_cpus;
+            double machine_max_util = machine.performance[machine_state.p_state] * machine.num_cpus;
 
             bool correct_cpu = task.required_cpu == machine.cpu;
-            bool enough_mem = machine.memory_used + task.required_memory + 8 < machine.memory_size;
+            bool enough_mem = machine_state.memory_used + task.required_memory + 8 < machine.memory_size;
             bool enough_util = machine_util + task_util <= machine_max_util;
 
             // dev notes: data struct to keep track of vm by vm_type?
@@ -278,10 +286,11 @@ void updateWaitingQueue(Time_t now) {
         }
 
         for (MachineId_t id : idle[task_cpu]) {
-            MachineInfo_t machine = Machine_GetInfo(id);
+            const MachineSpec_t & machine = Machine_GetSpec(id);
+            MachineStatus_t machine_state = Machine_GetStatus(id);
 
             bool correct_cpu = task.required_cpu == machine.cpu;
-            bool enough_mem = machine.memory_used + task.required_memory + 8 < machine.memory_size;
+            bool enough_mem = machine_state.memory_used + task.required_memory + 8 < machine.memory_size;
 
             // dev notes: state change issues? (if idle is moving around)
             // dev notes: is the change_state.count required?
@@ -299,10 +308,11 @@ void updateWaitingQueue(Time_t now) {
         }
 
         for (MachineId_t id : off[task_cpu]) {
-            MachineInfo_t machine = Machine_GetInfo(id);
+            const MachineSpec_t & machine = Machine_GetSpec(id);
+            MachineStatus_t machine_state = Machine_GetStatus(id);
 
             bool correct_cpu = task.required_cpu == machine.cpu;
-            bool enough_mem = machine.memory_used + task.required_memory + 8 < machine.memory_size;
+            bool enough_mem = machine_state.memory_used + task.required_memory + 8 < machine.memory_size;
 
             // dev notes: state change issues? (if idle is moving around)
             // dev notes: is the change_state.count required?
@@ -330,6 +340,12 @@ void Scheduler::PeriodicCheck(Time_t now) {
     // Recommendation: Take advantage of this function to do some monitoring and adjustments as necessary
     // about 1 sec between checks
     
+    // the simulator just advanced the tasks, so their rates are due again
+    ledger.Rebook(now);
+#ifdef DEBUG
+    ledger.Check(now);
+#endif
+
     if(now - wait_queue_time >= SECOND / 10) {
         wait_queue_time = now;
         updateWaitingQueue(now);
@@ -343,9 +359,10 @@ void Scheduler::PeriodicCheck(Time_t now) {
                 unsigned cpu_max_mips = 0;
                 
                 for (MachineId_t id : running[i]) {
-                    MachineInfo_t info = Machine_GetInfo(id);
+                    const MachineSpec_t & info = Machine_GetSpec(id);
+                    MachineStatus_t info_state = Machine_GetStatus(id);
                     cpu_total_mips += machine_eff_mips(id, now);
-                    cpu_max_mips += info.performance[info.p_state] * info.num_cpus;
+                    cpu_max_mips += info.performance[info_state.p_state] * info.num_cpus;
                 }
                 
                 double cpu_util = cpu_max_mips == 0 ? 0 : (double) cpu_total_mips / (double) cpu_max_mips;
@@ -360,7 +377,7 @@ void Scheduler::PeriodicCheck(Time_t now) {
                             Machine_SetState(id, RUNNING_S_STATE);
                             changing_state[id] = {IDLE_S_STATE, RUNNING_S_STATE, false, 0};
                             
-                            MachineInfo_t info = Machine_GetInfo(id);
+                            const MachineSpec_t & info = Machine_GetSpec(id);
                             cpu_max_mips += info.performance[P0] * info.num_cpus;
                             theoretical_util = cpu_max_mips == 0 ? 0 : cpu_total_mips / cpu_max_mips;
                         }
@@ -376,7 +393,7 @@ void Scheduler::PeriodicCheck(Time_t now) {
                             Machine_SetState(id, RUNNING_S_STATE);
                             changing_state[id] = {OFF_S_STATE, RUNNING_S_STATE, false, 0};
                             
-                            MachineInfo_t info = Machine_GetInfo(id);
+                            const MachineSpec_t & info = Machine_GetSpec(id);
                             cpu_max_mips += info.performance[P0] * info.num_cpus;
                             theoretical_util = cpu_max_mips == 0 ? 0 : cpu_total_mips / cpu_max_mips;
                         }
@@ -410,7 +427,7 @@ void Scheduler::PeriodicCheck(Time_t now) {
                                 Machine_SetState(id, IDLE_S_STATE);
                                 changing_state[id] = {RUNNING_S_STATE, IDLE_S_STATE, false, 0};
 
-                                MachineInfo_t info = Machine_GetInfo(id);
+                                const MachineSpec_t & info = Machine_GetSpec(id);
 
                                 if (info.performance[P0] * info.num_cpus > cpu_max_mips) {
                                     break;
@@ -443,6 +460,14 @@ void Scheduler::PeriodicCheck(Time_t now) {
     }
 }
 
+void Scheduler::Sample(TelemetrySample_t & sample) {
+    for (MachineId_t id = 0; id < (MachineId_t) total_machines; id++) {
+        sample.cpus[Machine_GetSpec(id).cpu].demand_mips += ledger.MachineDemand(id);
+    }
+    sample.waiting = queue.size();
+    sample.state_changes = changing_state.size();
+}
+
 void Scheduler::Shutdown(Time_t time) {
     // Do your final reporting and bookkeeping here.
     // Report about the total energy consumed
@@ -451,71 +476,19 @@ void Scheduler::Shutdown(Time_t time) {
     for(auto & vm: vms) {
         VM_Shutdown(vm);
     }
-    SimOutput("SimulationComplete(): Finished!", 4);
-    SimOutput("SimulationComplete(): Time is " + to_string(time), 4);
+    SIM_LOG(4, "SimulationComplete(): Finished!");
+    SIM_LOG(4, "SimulationComplete(): Time is ", time);
 }
 
 void Scheduler::TaskComplete(Time_t now, TaskId_t task_id) {
     // Do any bookkeeping necessary for the data structures
     // Decide if a machine is to be turned off, slowed down, or VMs to be migrated according to your policy
     // This is an opportunity to make any adjustments to optimize performance/energy
-    SimOutput("Scheduler::TaskComplete(): Task " + to_string(task_id) + " is complete at " + to_string(now), 4);
-}
-
-// Public interface below
-
-static Scheduler Scheduler;
-
-void InitScheduler() {
-    SimOutput("InitScheduler(): Initializing scheduler", 4);
-    Scheduler.Init();
+    ledger.RemoveTask(task_id);
+    SIM_LOG(4, "Scheduler::TaskComplete(): Task ", task_id, " is complete at ", now);
 }
 
-void HandleNewTask(Time_t time, TaskId_t task_id) {
-    SimOutput("HandleNewTask(): Received new task " + to_string(task_id) + " at time " + to_string(time), 4);
-    Scheduler.NewTask(time, task_id);
-}
-
-void HandleTaskCompletion(Time_t time, TaskId_t task_id) {
-    SimOutput("HandleTaskCompletion(): Task " + to_string(task_id) + " completed at time " + to_string(time), 4);
-    Scheduler.TaskComplete(time, task_id);
-}
-
-void MemoryWarning(Time_t time, MachineId_t machine_id) {
-    // The simulator is alerting you that machine identified by machine_id is overcommitted
-    SimOutput("MemoryWarning(): Overflow at " + to_string(machine_id) + " was detected at time " + to_string(time), 0);
-}
-
-void MigrationDone(Time_t time, VMId_t vm_id) {
-    // The function is called on to alert you that migration is complete
-    SimOutput("MigrationDone(): Migration of VM " + to_string(vm_id) + " was completed at time " + to_string(time), 4);
-    Scheduler.MigrationComplete(time, vm_id);
-}
-
-void SchedulerCheck(Time_t time) {
-    // This function is called periodically by the simulator, no specific event
-    SimOutput("SchedulerCheck(): SchedulerCheck() called at " + to_string(time), 4);
-    Scheduler.PeriodicCheck(time);
-}
-
-void SimulationComplete(Time_t time) {
-    // This function is called before the simulation terminates Add whatever you feel like.
-    cout << "SLA violation report" << endl;
-    cout << "SLA0: " << GetSLAReport(SLA0) << "%" << endl;
-    cout << "SLA1: " << GetSLAReport(SLA1) << "%" << endl;
-    cout << "SLA2: " << GetSLAReport(SLA2) << "%" << endl;     // SLA3 do not have SLA violation issues
-    cout << "Total Energy " << Machine_GetClusterEnergy() << "KW-Hour" << endl;
-    cout << "Simulation run finished in " << double(time)/1000000 << " seconds" << endl;
-    SimOutput("SimulationComplete(): Simulation finished at time " + to_string(time), 4);
-    
-    Scheduler.Shutdown(time);
-}
-
-void SLAWarning(Time_t time, TaskId_t task_id) {
-    
-}
-
-void StateChangeComplete(Time_t time, MachineId_t machine_id) {
+void Scheduler::StateChangeComplete(Time_t time, MachineId_t machine_id) {
     stateChangeInfo info = changing_state[machine_id];
     
     // either idle machine or off machine woken for task assignment
@@ -523,24 +496,32 @@ void StateChangeComplete(Time_t time, MachineId_t machine_id) {
         FindVMAddTask(machine_id, info.task);
     }
 
-    CPUType_t machine_cpu = Machine_GetInfo(machine_id).cpu;
+    CPUType_t machine_cpu = Machine_GetSpec(machine_id).cpu;
     // dev notes: state change issues?
     if (info.old_state == RUNNING_S_STATE) {
-        running[machine_cpu].erase(remove(running[machine_cpu].begin(), running[machine_cpu].end(), machine_id), running[machine_cpu].end());
+        running[machine_cpu].Remove(machine_id);
     } else if (info.old_state == IDLE_S_STATE) {
-        idle[machine_cpu].erase(remove(idle[machine_cpu].begin(), idle[machine_cpu].end(), machine_id), idle[machine_cpu].end());
+        idle[machine_cpu].Remove(machine_id);
     } else {
-        off[machine_cpu].erase(remove(off[machine_cpu].begin(), off[machine_cpu].end(), machine_id), off[machine_cpu].end());
+        off[machine_cpu].Remove(machine_id);
     }
 
     // dev notes: state change issues?
     if (info.new_state == RUNNING_S_STATE) {
-        running[machine_cpu].push_back(machine_id);
+        running[machine_cpu].Add(machine_id);
     } else if (info.old_state == IDLE_S_STATE) {
-        idle[machine_cpu].push_back(machine_id);
+        idle[machine_cpu].Add(machine_id);
     } else {
-        off[machine_cpu].push_back(machine_id);
+        off[machine_cpu].Add(machine_id);
     }
 
     changing_state.erase(machine_id);
-}
\ No newline at end of file
+}
+
+SchedulerPolicy * Create() {
+    return new Scheduler();
+}
+
+static bool registered = Scheduler_Register("eeco", Create);
+
+} // namespace eeco_policy
@@ -7,6 +7,9 @@
 // Greedy
 
 #include "Scheduler.hpp"
+#include "DemandLedger.hpp"
+#include "Log.h"
+#include "LoadOrder.hpp"
 
 // own imports
 // for erase and remove
@@ -17,37 +20,68 @@
 #include <deque>
 
 using namespace std;
-//stores machines and vms on the machines
-vector<vector<VMId_t>> machine_matrix;
-// list of vms per machine
-int total_machines;
 
-// lists of active and inactive machines
-vector<MachineId_t> active;
-vector<MachineId_t> inactive;
+namespace greedy_policy {
 
-//map task-> vm info
-unordered_map<unsigned, unsigned> task_to_vm;
-
-// stores vms that are currently being migrated
-unordered_set<unsigned> migrating_vms; 
 // store the machines that are currently being state changed, and info about it
-
 struct state_change_info {
     bool for_new_task; //true if new task, false if slawarning
     TaskId_t new_task_id;
     VMId_t sla_violating_vm;
 };
-unordered_map<unsigned, state_change_info> state_changing_machines;
-
-int rand_machine_index;
-
-// dev notes: new e-eco tech
-deque<unsigned> not_assigned_queue;
-Time_t last_time = 0;
 const uint64_t SECOND = 1000000;
 
-bool state_changing_machines_contains(unsigned key)
+class Scheduler : public SchedulerPolicy {
+public:
+    Scheduler()                 {}
+    void Init();
+    void MigrationComplete(Time_t time, VMId_t vm_id);
+    void NewTask(Time_t now, TaskId_t task_id);
+    void PeriodicCheck(Time_t now);
+    void Sample(TelemetrySample_t & sample);
+    void Shutdown(Time_t now);
+    void SLAWarning(Time_t time, TaskId_t task_id);
+    void StateChangeComplete(Time_t time, MachineId_t machine_id);
+    void TaskComplete(Time_t now, TaskId_t task_id);
+private:
+    vector<VMId_t> vms;
+    vector<MachineId_t> machines;
+
+    double machine_utilization(MachineId_t machine_id, Time_t curr);
+    void rebook(Time_t now);
+    bool state_changing_machines_contains(unsigned key);
+    void update_active(MachineId_t machine_id);
+    double vm_utilization(VMId_t vm_id, MachineId_t machine_id, Time_t curr);
+
+    //stores machines and vms on the machines
+    vector<vector<VMId_t>> machine_matrix;
+    // list of vms per machine
+    int total_machines = 0;
+
+    // Booked mips per task, vm and machine
+    DemandLedger ledger;
+
+    // active machines, least utilized first, and inactive machines
+    LoadOrder active;
+    vector<MachineId_t> inactive;
+
+    //map task-> vm info
+    unordered_map<unsigned, unsigned> task_to_vm;
+
+    // stores vms that are currently being migrated
+    unordered_set<unsigned> migrating_vms; 
+    unordered_map<unsigned, state_change_info> state_changing_machines;
+
+    int rand_machine_index = 0;
+
+    // dev notes: new e-eco tech
+    deque<unsigned> not_assigned_queue;
+    Time_t last_time = 0;
+
+    int sla_violations = 0;
+};
+
+bool Scheduler::state_changing_machines_contains(unsigned key)
 {
     // Key is not present
     if (state_changing_machines.find(key) == state_changing_machines.end())
@@ -56,63 +90,71 @@ bool state_changing_machines_contains(unsigned key)
 }
 
 /*
-Gets the total utilization of a vm
+Gets the mips a task needs to meet its target, the demand the ledger books
 */
-double task_utilization(TaskId_t task_id, MachineId_t machine_id, Time_t curr) {
-    TaskInfo_t info = GetTaskInfo(task_id);
+double task_demand(uint64_t remaining, uint64_t total, Time_t target, Time_t curr) {
+    double remaining_instr = (double) remaining;
+    double time_frame = (double) target - curr;
 
-    double remaining_instr = (double) info.remaining_instructions;
-    double time_frame = (double) info.target_completion - curr;
+    return remaining_instr / time_frame;
+}
+
+double task_mips(TaskId_t task_id, Time_t curr) {
+    return task_demand(GetTaskRemainingInstructions(task_id), GetTaskTotalInstructions(task_id), GetTaskTargetCompletion(task_id), curr);
+}
 
-    double eff_mips = remaining_instr / time_frame;
+/*
+Gets the total utilization of a vm
+*/
+double task_utilization(TaskId_t task_id, MachineId_t machine_id, Time_t curr) {
+    double eff_mips = task_mips(task_id, curr);
 
-    MachineInfo_t machine_info = Machine_GetInfo(machine_id);
-    double actual_mips = machine_info.performance[machine_info.p_state] * machine_info.num_cpus;
+    const MachineSpec_t & machine = Machine_GetSpec(machine_id);
+    MachineStatus_t machine_state = Machine_GetStatus(machine_id);
+    double actual_mips = machine.performance[machine_state.p_state] * machine.num_cpus;
     
 	return eff_mips / actual_mips;
 }
 
-// assumes one task per vm
-double vm_utilization(VMId_t vm_id, MachineId_t machine_id, Time_t curr) {
-    double utilization = 0.0;
+// booked utilization of a vm if it ran on machine_id
+double Scheduler::vm_utilization(VMId_t vm_id, MachineId_t machine_id, Time_t curr) {
+    const MachineSpec_t & machine = Machine_GetSpec(machine_id);
+    MachineStatus_t machine_state = Machine_GetStatus(machine_id);
+    double actual_mips = machine.performance[machine_state.p_state] * machine.num_cpus;
 
-    for(int i = 0; i < VM_GetInfo(vm_id).active_tasks.size(); i++) {
-        utilization += task_utilization(VM_GetInfo(vm_id).active_tasks[i], machine_id, curr);
-    }
-    
-    return utilization;
+    return ledger.VMDemand(vm_id) / actual_mips;
 }
 
 /*
-Gets the total utilization of a machine
+Gets the total booked utilization of a machine
 */
-double machine_utilization(MachineId_t machine_id, Time_t curr) {
-	double eff_mips = 0.0;
-
-    for (VMId_t vm_id : machine_matrix[machine_id]) {
-        for (TaskId_t task_id : VM_GetInfo(vm_id).active_tasks) {
-            TaskInfo_t info = GetTaskInfo(task_id);
-
-            double remaining_instr = (double) info.remaining_instructions;
-            double time_frame = (double) info.target_completion - curr;
+double Scheduler::machine_utilization(MachineId_t machine_id, Time_t curr) {
+	double eff_mips = ledger.MachineDemand(machine_id);
 
-            eff_mips += remaining_instr / time_frame;
-        }
-    }
-
-    MachineInfo_t machine_info = Machine_GetInfo(machine_id);
-    double actual_mips = machine_info.performance[machine_info.p_state] * machine_info.num_cpus;
+    const MachineSpec_t & machine = Machine_GetSpec(machine_id);
+    MachineStatus_t machine_state = Machine_GetStatus(machine_id);
+    double actual_mips = machine.performance[machine_state.p_state] * machine.num_cpus;
     
 	return eff_mips / actual_mips;
 }
 
 /*
-compares the utilization of two machines
+rebooks every task's demand at now and re-keys the active machines on it
 */
-bool util_comp(MachineId_t a, MachineId_t b) {
-	double util_a = machine_utilization(a, Now());
-	double util_b = machine_utilization(b, Now());
-	return util_a < util_b;
+void Scheduler::rebook(Time_t now) {
+    ledger.Rebook(now);
+    for (MachineId_t machine_id : active) {
+        active.Update(machine_id, machine_utilization(machine_id, now));
+    }
+}
+
+/*
+re-keys an active machine after its booked utilization changed
+*/
+void Scheduler::update_active(MachineId_t machine_id) {
+    if (active.Contains(machine_id)) {
+        active.Update(machine_id, machine_utilization(machine_id, Now()));
+    }
 }
 
 // convert sla to prio
@@ -123,7 +165,6 @@ Priority_t sla_to_prio(SLAType_t sla) {
     return LOW_PRIORITY;
 }
 
-
 void Scheduler::Init() {
     // Find the parameters of the clusters
     // Get the total number of machines
@@ -133,10 +174,10 @@ void Scheduler::Init() {
     //      Get the number of CPUs
     //      Get if there is a GPU or not
     // 
-    SimOutput("Scheduler::Init(): Total number of machines is " + to_string(Machine_GetTotal()), 3);
-    SimOutput("Scheduler::Init(): Initializing scheduler", 1);
+    SIM_LOG(3, "Scheduler::Init(): Total number of machines is ", Machine_GetTotal());
+    SIM_LOG(1, "Scheduler::Init(): Initializing scheduler");
     total_machines = Machine_GetTotal();
-    active = {};
+    ledger.Init(total_machines, task_demand);
     inactive = {};
     rand_machine_index = 0;
     for (int i = 0; i < total_machines; ++i) {
@@ -148,7 +189,7 @@ void Scheduler::Init() {
 
         }
         else {
-            active.push_back(i);
+            active.Update(i, 0.0);
         }
         vector<VMId_t> temp = {};
         machine_matrix.push_back(temp);
@@ -157,37 +198,41 @@ void Scheduler::Init() {
 }
 
 void Scheduler::MigrationComplete(Time_t time, VMId_t vm_id) {
-    MachineId_t machine_id = VM_GetInfo(vm_id).machine_id;
     migrating_vms.erase(vm_id);
 }
 
 void Scheduler::NewTask(Time_t now, TaskId_t task_id) {
-    TaskInfo_t task_info = GetTaskInfo(task_id);
+    rebook(now);
+    TaskRequirements_t task_info = GetTaskRequirements(task_id);
 
-    sort(active.begin(), active.end(), util_comp);
+    active.Sort();
     for(MachineId_t id : active) {
-        MachineInfo_t curr_machine = Machine_GetInfo(id);
+        double util = active.Load(id);
+        const MachineSpec_t & curr_machine = Machine_GetSpec(id);
+        MachineStatus_t curr_machine_state = Machine_GetStatus(id);
         double task_util = task_utilization(task_id, id, now);
         if(curr_machine.cpu == task_info.required_cpu && 
-            task_util + machine_utilization(id, now) < 1.0 && 
-            curr_machine.memory_used + task_info.required_memory + 8 < curr_machine.memory_size &&
-            curr_machine.s_state == S0 && !state_changing_machines_contains(id)) {
+            task_util + util < 1.0 && 
+            curr_machine_state.memory_used + task_info.required_memory + 8 < curr_machine.memory_size &&
+            curr_machine_state.s_state == S0 && !state_changing_machines_contains(id)) {
                 
                 VMId_t new_vm = VM_Create(task_info.required_vm, task_info.required_cpu);
                 VM_Attach(new_vm, id);
                 VM_AddTask(new_vm, task_id, sla_to_prio(task_info.required_sla));
+                ledger.AddTask(task_id, new_vm, id, Now());
 
                 machine_matrix[id].push_back(new_vm);
                 task_to_vm[task_id] = new_vm;
+                update_active(id);
                 return;
             }
-        else if (task_util + machine_utilization(id, now) >= 1.0) {
+        else if (task_util + util >= 1.0) {
             break;
         }
     }
 
     for(MachineId_t id : inactive) {
-        MachineInfo_t curr_machine = Machine_GetInfo(id);
+        const MachineSpec_t & curr_machine = Machine_GetSpec(id);
         if(curr_machine.cpu == task_info.required_cpu) {
             inactive.erase(remove(inactive.begin(), inactive.end(), id), inactive.end());
             Machine_SetState(id, S0);
@@ -205,6 +250,15 @@ void Scheduler::PeriodicCheck(Time_t now) {
     // SchedulerCheck is called periodically by the simulator to allow you to monitor, make decisions, adjustments, etc.
     // Unlike the other invocations of the scheduler, this one doesn't report any specific event
     // Recommendation: Take advantage of this function to do some monitoring and adjustments as necessary
+    rebook(now);
+#ifdef DEBUG
+    ledger.Check(now);
+    for (MachineId_t id : active) {
+        if (active.Load(id) != machine_utilization(id, now)) {
+            ThrowException("Scheduler::PeriodicCheck(): Stale utilization of active machine ", id);
+        }
+    }
+#endif
 
     if (now - last_time > SECOND) {
         last_time = now;
@@ -212,27 +266,32 @@ void Scheduler::PeriodicCheck(Time_t now) {
         while (not_assigned_queue.size() > 0) {
             // dev notes: could also be not_assigned_queue.front()?
             TaskId_t task_id = not_assigned_queue.front();
-            TaskInfo_t task_info = GetTaskInfo(task_id);
+            TaskRequirements_t task_info = GetTaskRequirements(task_id);
 
             bool task_assigned = false;
 
+            // not re-sorted, the walk keeps the order of the last sort
             for(MachineId_t id : active) {
-                MachineInfo_t curr_machine = Machine_GetInfo(id);
+                double util = active.Load(id);
+                const MachineSpec_t & curr_machine = Machine_GetSpec(id);
+                MachineStatus_t curr_machine_state = Machine_GetStatus(id);
                 double task_util = task_utilization(task_id, id, now);
                 if(curr_machine.cpu == task_info.required_cpu && 
-                    task_util + machine_utilization(id, now) < 1.0 && 
-                    curr_machine.memory_used + task_info.required_memory + 8 < curr_machine.memory_size &&
-                    curr_machine.s_state == S0 && !state_changing_machines_contains(id)) {
+                    task_util + util < 1.0 && 
+                    curr_machine_state.memory_used + task_info.required_memory + 8 < curr_machine.memory_size &&
+                    curr_machine_state.s_state == S0 && !state_changing_machines_contains(id)) {
                         
                     VMId_t new_vm = VM_Create(task_info.required_vm, task_info.required_cpu);
                     VM_Attach(new_vm, id);
                     VM_AddTask(new_vm, task_id, sla_to_prio(task_info.required_sla));
+                    ledger.AddTask(task_id, new_vm, id, Now());
 
                     machine_matrix[id].push_back(new_vm);
                     task_to_vm[task_id] = new_vm;
                     
                     not_assigned_queue.pop_front();
                     task_assigned = true;
+                    update_active(id);
                     break;
                 }
             }
@@ -240,7 +299,7 @@ void Scheduler::PeriodicCheck(Time_t now) {
             if (task_assigned) continue;
 
             for(MachineId_t id : inactive) {
-                MachineInfo_t curr_machine = Machine_GetInfo(id);
+                const MachineSpec_t & curr_machine = Machine_GetSpec(id);
                 if(curr_machine.cpu == task_info.required_cpu) {
                     inactive.erase(remove(inactive.begin(), inactive.end(), id), inactive.end());
                     Machine_SetState(id, S0);
@@ -263,6 +322,14 @@ void Scheduler::PeriodicCheck(Time_t now) {
     }
 }
 
+void Scheduler::Sample(TelemetrySample_t & sample) {
+    for (MachineId_t id = 0; id < (MachineId_t) total_machines; id++) {
+        sample.cpus[Machine_GetSpec(id).cpu].demand_mips += ledger.MachineDemand(id);
+    }
+    sample.waiting = not_assigned_queue.size();
+    sample.state_changes = state_changing_machines.size();
+}
+
 void Scheduler::Shutdown(Time_t time) {
     // Do your final reporting and bookkeeping here.
     // Report about the total energy consumed
@@ -271,8 +338,8 @@ void Scheduler::Shutdown(Time_t time) {
     for(auto & vm: vms) {
         VM_Shutdown(vm);
     }
-    SimOutput("SimulationComplete(): Finished!", 4);
-    SimOutput("SimulationComplete(): Time is " + to_string(time), 4);
+    SIM_LOG(4, "SimulationComplete(): Finished!");
+    SIM_LOG(4, "SimulationComplete(): Time is ", time);
 }
 
 void Scheduler::TaskComplete(Time_t now, TaskId_t task_id) {
@@ -281,10 +348,15 @@ void Scheduler::TaskComplete(Time_t now, TaskId_t task_id) {
     // Do any bookkeeping necessary for the data structures
     // Decide if a machine is to be turned off, slowed down, or VMs to be migrated according to your policy
     // This is an opportunity to make any adjustments to optimize performance/energy
+    rebook(now);
     // shutdown old vm
     VMId_t old_vm = task_to_vm[task_id];
     MachineId_t curr_machine = VM_GetInfo(old_vm).machine_id;
+    // the booking stays with the migration target while the vm is in flight
+    MachineId_t booked_machine = ledger.VMMachine(old_vm);
     task_to_vm.erase(task_id);
+    ledger.RemoveTask(task_id);
+    update_active(booked_machine);
 
     // cout << "before removal :";
     // for (int i = 0; i < machine_matrix[curr_machine].size(); i++) {
@@ -301,10 +373,10 @@ void Scheduler::TaskComplete(Time_t now, TaskId_t task_id) {
     // cout << endl;
     // cout << endl;
 
-    sort(active.begin(), active.end(), util_comp);
+    active.Sort();
     //loop through all active machines
     for(MachineId_t machine_id : active) {
-        if (Machine_GetInfo(curr_machine).active_vms == 0) {
+        if (Machine_GetStatus(curr_machine).active_vms == 0) {
             break;
         }
         if(machine_id != curr_machine) {
@@ -314,19 +386,21 @@ void Scheduler::TaskComplete(Time_t now, TaskId_t task_id) {
                 VMId_t vm_id = machine_matrix[curr_machine][i];
                 if(!migrating_vms.count(vm_id)) {
                     double vm_util = vm_utilization(vm_id, machine_id, now);
-                    MachineInfo_t new_machine = Machine_GetInfo(machine_id);
-                    VMInfo_t vm_info = VM_GetInfo(vm_id);
+                    const MachineSpec_t & new_machine = Machine_GetSpec(machine_id);
+                    MachineStatus_t new_machine_state = Machine_GetStatus(machine_id);
                     unsigned vm_memory = 0;
-                    for (TaskId_t task : vm_info.active_tasks) {
-                        vm_memory += GetTaskInfo(task).required_memory;
+                    for (TaskId_t task : VM_GetTasks(vm_id)) {
+                        vm_memory += GetTaskMemory(task);
                     }
-                    if (!state_changing_machines_contains(machine_id) && new_machine.cpu == vm_info.cpu &&
+                    if (!state_changing_machines_contains(machine_id) && new_machine.cpu == Machine_GetSpec(curr_machine).cpu &&
                         machine_utilization(machine_id, now) + vm_util < 1.0 &&
-                        new_machine.memory_used + vm_memory + 8 < new_machine.memory_size) {
+                        new_machine_state.memory_used + vm_memory + 8 < new_machine.memory_size) {
                         machine_matrix[curr_machine].erase(remove(machine_matrix[curr_machine].begin(), 
                                 machine_matrix[curr_machine].end(), vm_id), machine_matrix[curr_machine].end());
                         migrating_vms.insert(vm_id);
                         VM_Migrate(vm_id, machine_id);
+                        ledger.MoveVM(vm_id, machine_id);
+                        update_active(machine_id);
                         machine_matrix[machine_id].push_back(vm_id);
                         break;
                     }
@@ -335,74 +409,24 @@ void Scheduler::TaskComplete(Time_t now, TaskId_t task_id) {
         }
     }
 
-    if(VM_GetInfo(old_vm).active_tasks.size() == 0 && !migrating_vms.count(old_vm)) {
+    update_active(curr_machine);
+
+    if(VM_GetTasks(old_vm).empty() && !migrating_vms.count(old_vm)) {
         machine_matrix[curr_machine].erase(remove(machine_matrix[curr_machine].begin(), 
                 machine_matrix[curr_machine].end(), old_vm), machine_matrix[curr_machine].end());
         VM_Shutdown(old_vm);
     }
 
     if(machine_matrix[curr_machine].size() == 0) {
-        active.erase(remove(active.begin(), active.end(), curr_machine), active.end());
+        active.Remove(curr_machine);
         Machine_SetState(curr_machine, S2);
         // state_change_info temp = {false, 0, 0};
         state_changing_machines[curr_machine] = {false, 0, 0};
     }
-    SimOutput("Scheduler::TaskComplete(): Task " + to_string(task_id) + " is complete at " + to_string(now), 4);
+    SIM_LOG(4, "Scheduler::TaskComplete(): Task ", task_id, " is complete at ", now);
 }
 
-// Public interface below
-
-static Scheduler Scheduler;
-
-void InitScheduler() {
-    SimOutput("InitScheduler(): Initializing scheduler", 4);
-    Scheduler.Init();
-}
-
-void HandleNewTask(Time_t time, TaskId_t task_id) {
-    SimOutput("HandleNewTask(): Received new task " + to_string(task_id) + " at time " + to_string(time), 4);
-    Scheduler.NewTask(time, task_id);
-}
-
-void HandleTaskCompletion(Time_t time, TaskId_t task_id) {
-    SimOutput("HandleTaskCompletion(): Task " + to_string(task_id) + " completed at time " + to_string(time), 4);
-    Scheduler.TaskComplete(time, task_id);
-}
-
-void MemoryWarning(Time_t time, MachineId_t machine_id) {
-    // The simulator is alerting you that machine identified by machine_id is overcommitted
-    SimOutput("MemoryWarning(): Overflow at " + to_string(machine_id) + " was detected at time " + to_string(time), 0);
-}
-
-void MigrationDone(Time_t time, VMId_t vm_id) {
-    // The function is called on to alert you that migration is complete
-    SimOutput("MigrationDone(): Migration of VM " + to_string(vm_id) + " was completed at time " + to_string(time), 4);
-    Scheduler.MigrationComplete(time, vm_id);
-}
-
-void SchedulerCheck(Time_t time) {
-    // This function is called periodically by the simulator, no specific event
-    // printf("scheduler check called\n");
-    SimOutput("SchedulerCheck(): SchedulerCheck() called at " + to_string(time), 4);
-    Scheduler.PeriodicCheck(time);
-}
-
-void SimulationComplete(Time_t time) {
-    // This function is called before the simulation terminates Add whatever you feel like.
-    cout << "SLA violation report" << endl;
-    cout << "SLA0: " << GetSLAReport(SLA0) << "%" << endl;
-    cout << "SLA1: " << GetSLAReport(SLA1) << "%" << endl;
-    cout << "SLA2: " << GetSLAReport(SLA2) << "%" << endl;     // SLA3 do not have SLA violation issues
-    cout << "Total Energy " << Machine_GetClusterEnergy() << "KW-Hour" << endl;
-    cout << "Simulation run finished in " << double(time)/1000000 << " seconds" << endl;
-    SimOutput("SimulationComplete(): Simulation finished at time " + to_string(time), 4);
-    
-    Scheduler.Shutdown(time);
-}
-
-int sla_violations = 0;
-
-void SLAWarning(Time_t time, TaskId_t task_id) {
+void Scheduler::SLAWarning(Time_t time, TaskId_t task_id) {
     // return;
     // -- Pseudocode --
     // Assume workload i violates SLA on machine J
@@ -413,7 +437,8 @@ void SLAWarning(Time_t time, TaskId_t task_id) {
     // Else Failure
 
     // assumption: look thru active machines, if unsuccessful then inactive machine
-    TaskInfo_t task_info = GetTaskInfo(task_id);
+    rebook(time);
+    TaskRequirements_t task_info = GetTaskRequirements(task_id);
 
     VMId_t old_vm = task_to_vm[task_id];
     MachineId_t old_machine = VM_GetInfo(old_vm).machine_id;
@@ -422,29 +447,33 @@ void SLAWarning(Time_t time, TaskId_t task_id) {
         return;
     }
 
-    sort(active.begin(), active.end(), util_comp);
-
+    active.Sort();
     for (MachineId_t id : active) {
+        double util = active.Load(id);
         if (id != old_machine) {
-            MachineInfo_t curr_machine = Machine_GetInfo(id);
+            const MachineSpec_t & curr_machine = Machine_GetSpec(id);
+            MachineStatus_t curr_machine_state = Machine_GetStatus(id);
             double task_util = task_utilization(task_id, id, time);
             
             if(curr_machine.cpu == task_info.required_cpu && 
-                    task_util + machine_utilization(id, time) < 1.0 && 
-                    curr_machine.memory_used + task_info.required_memory + 8 < curr_machine.memory_size) {
+                    task_util + util < 1.0 && 
+                    curr_machine_state.memory_used + task_info.required_memory + 8 < curr_machine.memory_size) {
                 // printf("failed here\n");
                 VM_Migrate(old_vm, id);
+                ledger.MoveVM(old_vm, id);
                 machine_matrix[old_machine].erase(remove(machine_matrix[old_machine].begin(), 
                     machine_matrix[old_machine].end(), old_vm), machine_matrix[old_machine].end());
                 machine_matrix[id].push_back(old_vm);
                 migrating_vms.insert(old_vm);
+                update_active(old_machine);
+                update_active(id);
                 return;
             }
         }
     }
 
     for (MachineId_t id : inactive) {
-        MachineInfo_t curr_machine = Machine_GetInfo(id);
+        const MachineSpec_t & curr_machine = Machine_GetSpec(id);
         
         if (curr_machine.cpu == task_info.required_cpu) {
             inactive.erase(remove(inactive.begin(), inactive.end(), id), inactive.end());
@@ -461,28 +490,33 @@ void SLAWarning(Time_t time, TaskId_t task_id) {
     }
 }
 
-void StateChangeComplete(Time_t time, MachineId_t machine_id) {
+void Scheduler::StateChangeComplete(Time_t time, MachineId_t machine_id) {
     // Called in response to an earlier request to change the state of a machine
+    rebook(time);
 
-    MachineInfo_t machine_info = Machine_GetInfo(machine_id);
+    MachineStatus_t machine_info = Machine_GetStatus(machine_id);
     
     if (machine_info.s_state == S0) {
         state_change_info info = state_changing_machines[machine_id];
         // for assigning tasks to inactive machine once woken
         // new task
-        active.push_back(machine_id);
         if (info.for_new_task) {
-            TaskInfo_t task_info = GetTaskInfo(info.new_task_id);
+            TaskRequirements_t task_info = GetTaskRequirements(info.new_task_id);
             VMId_t new_vm = VM_Create(task_info.required_vm, task_info.required_cpu);
             VM_Attach(new_vm, machine_id);
             VM_AddTask(new_vm, info.new_task_id, sla_to_prio(task_info.required_sla));
+            ledger.AddTask(info.new_task_id, new_vm, machine_id, Now());
             machine_matrix[machine_id].push_back(new_vm);
             task_to_vm[info.new_task_id] = new_vm;
         // sla warning
         } else {
+            MachineId_t old_machine = ledger.VMMachine(info.sla_violating_vm);
             VM_Migrate(info.sla_violating_vm, machine_id);
+            ledger.MoveVM(info.sla_violating_vm, machine_id);
+            update_active(old_machine);
             machine_matrix[machine_id].push_back(info.sla_violating_vm);
         }
+        active.Update(machine_id, machine_utilization(machine_id, time));
     } else {
         inactive.push_back(machine_id);
     }
@@ -493,8 +527,10 @@ void StateChangeComplete(Time_t time, MachineId_t machine_id) {
 
 }
 
+SchedulerPolicy * Create() {
+    return new Scheduler();
+}
 
+static bool registered = Scheduler_Register("greedy", Create);
 
-
-
-
+} // namespace greedy_policy
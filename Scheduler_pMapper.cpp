@@ -6,54 +6,154 @@
 // pMapper
 
 #include "Scheduler.hpp"
+#include "DemandKernel.h"
+#include "DemandLedger.hpp"
+#include "Log.h"
 
 // own imports
 // for erase and remove
 #include <algorithm>
+#include <array>
+#include <set>
 #include <unordered_map>
 #include <unordered_set>
 #include <deque>
 
 using namespace std;
-//stores machines and vms on the machines
-vector<vector<VMId_t>> machine_matrix;
-// list of vms per machine
-int total_machines;
 
-//map task-> vm info
-unordered_map<unsigned, unsigned> task_to_vm;
+namespace pmapper_policy {
 
-// stores vms that are currently being migrated
-unordered_set<unsigned> migrating_vms; 
 // store the machines that are currently being state changed, and info about it
-
 struct state_change_info {
     bool for_new_task; //true if new task, false if slawarning
     TaskId_t new_task_id;
     VMId_t sla_violating_vm;
 };
-unordered_map<unsigned, state_change_info> state_changing_machines;
 
-//sorted list of machines based on their efficiency
-vector<unsigned> eff_list;
+// machines with the same cpu, core count and power table share their efficiency
+struct machine_class {
+    CPUType_t cpu;
+    unsigned num_cpus;
+    vector<unsigned> performance;
+    vector<unsigned> p_states;
+    array<double, P_STATES> efficiency;     // mips per watt at each p-state
+};
+
+class Scheduler : public SchedulerPolicy {
+public:
+    Scheduler()                 {}
+    void Init();
+    void MigrationComplete(Time_t time, VMId_t vm_id);
+    void NewTask(Time_t now, TaskId_t task_id);
+    void PeriodicCheck(Time_t now);
+    void Sample(TelemetrySample_t & sample);
+    void Shutdown(Time_t now);
+    void StateChangeComplete(Time_t time, MachineId_t machine_id);
+    void TaskComplete(Time_t now, TaskId_t task_id);
+private:
+    vector<VMId_t> vms;
+    vector<MachineId_t> machines;
+
+    unsigned classify_machine(MachineId_t machine_id);
+    bool efficiency_comparator(MachineId_t a, MachineId_t b);
+    double machine_efficiency(MachineId_t machine_id, CPUPerformance_t p_state);
+    double machine_utilization(MachineId_t machine_id, Time_t curr);
+    void rebook(Time_t now);
+    void power_down_first_empty();
+    bool state_changing_machines_contains(unsigned key);
+    void update_empty(MachineId_t machine_id);
+    double vm_utilization(VMId_t vm_id, MachineId_t machine_id, Time_t curr);
+
+    //stores machines and vms on the machines
+    vector<vector<VMId_t>> machine_matrix;
+    // list of vms per machine
+    int total_machines = 0;
+
+    // Booked mips per task, vm and machine
+    DemandLedger ledger;
+
+    //map task-> vm info
+    unordered_map<unsigned, unsigned> task_to_vm;
+
+    // stores vms that are currently being migrated
+    unordered_set<unsigned> migrating_vms; 
+    unordered_map<unsigned, state_change_info> state_changing_machines;
+    vector<machine_class> machine_classes;
+    vector<unsigned> class_of;
+
+    //sorted list of machines based on their efficiency, and the same per cpu type
+    vector<unsigned> eff_list;
+    vector<vector<MachineId_t>> eff_by_cpu;
+    // position of each machine in eff_list
+    vector<unsigned> eff_rank;
+    // eff_list positions of the machines without booked demand
+    set<unsigned> empty_ranks;
+
+    deque<unsigned> queue;
+
+    Time_t last = 0;
+};
+
+// finds or adds the class of a machine
+unsigned Scheduler::classify_machine(MachineId_t machine_id) {
+    const MachineSpec_t & machine = Machine_GetSpec(machine_id);
+    for (unsigned i = 0; i < machine_classes.size(); i++) {
+        const machine_class & c = machine_classes[i];
+        if (c.cpu == machine.cpu && c.num_cpus == machine.num_cpus &&
+            c.performance == machine.performance && c.p_states == machine.p_states) {
+            return i;
+        }
+    }
+    machine_class c = {machine.cpu, machine.num_cpus, machine.performance, machine.p_states, {}};
+    for (unsigned p = 0; p < P_STATES; p++) {
+        c.efficiency[p] = (double) c.performance[p] / (c.p_states[p] * c.num_cpus);
+    }
+    machine_classes.push_back(c);
+    return machine_classes.size() - 1;
+}
+
+double Scheduler::machine_efficiency(MachineId_t machine_id, CPUPerformance_t p_state) {
+    return machine_classes[class_of[machine_id]].efficiency[p_state];
+}
 
-deque<unsigned> queue;
+// efficiency based comparator, ties go to the lower id
+bool Scheduler::efficiency_comparator(MachineId_t a, MachineId_t b) {
+    double eff_a = machine_efficiency(a, P0);
+    double eff_b = machine_efficiency(b, P0);
+    return eff_a < eff_b || (eff_a == eff_b && a < b);
+}
 
-Time_t last = 0;
+// tracks whether a machine has booked demand after the ledger changed
+void Scheduler::update_empty(MachineId_t machine_id) {
+    if (machine_id >= eff_rank.size()) {
+        return;
+    }
+    if (ledger.MachineDemand(machine_id) == 0.0) {
+        empty_ranks.insert(eff_rank[machine_id]);
+    } else {
+        empty_ranks.erase(eff_rank[machine_id]);
+    }
+}
 
-// efficiency based comparator
-bool efficiency_comparator(MachineId_t a, MachineId_t b) {
-    double perf_a = Machine_GetInfo(a).performance[P0];
-    double energy_a = Machine_GetInfo(a).p_states[P0] * Machine_GetInfo(a).num_cpus;
-    double eff_a = perf_a / energy_a;
-    double perf_b = Machine_GetInfo(b).performance[P0];
-    double energy_b = Machine_GetInfo(b).p_states[P0] * Machine_GetInfo(b).num_cpus;
-    double eff_b = perf_b / energy_b;
-    return eff_a < eff_b;
+// rebooks every task's demand at now, which can empty or fill a machine
+void Scheduler::rebook(Time_t now) {
+    ledger.Rebook(now);
+    for (MachineId_t machine_id = 0; machine_id < (MachineId_t) total_machines; machine_id++) {
+        update_empty(machine_id);
+    }
 }
 
+// powers down the least efficient machine without booked demand
+void Scheduler::power_down_first_empty() {
+    if (empty_ranks.empty()) {
+        return;
+    }
+    MachineId_t id = eff_list[*empty_ranks.begin()];
+    Machine_SetState(id, S1);
+    state_changing_machines[id] = {true, 0, 0};
+}
 
-bool state_changing_machines_contains(unsigned key)
+bool Scheduler::state_changing_machines_contains(unsigned key)
 {
     // Key is not present
     if (state_changing_machines.find(key) == state_changing_machines.end())
@@ -62,65 +162,54 @@ bool state_changing_machines_contains(unsigned key)
 }
 
 /*
-Gets the total utilization of a vm
+Gets the mips a task needs to meet its target, the demand the ledger books
 */
-double task_utilization(TaskId_t task_id, MachineId_t machine_id, Time_t curr) {
-    TaskInfo_t info = GetTaskInfo(task_id);
+double task_demand(uint64_t remaining, uint64_t total, Time_t target, Time_t curr) {
+    double remaining_instr = (double) remaining;
+    double time_frame = (double) target - curr;
 
-    double remaining_instr = (double) info.remaining_instructions;
-    double time_frame = (double) info.target_completion - curr;
+    return remaining_instr / time_frame;
+}
+
+double task_mips(TaskId_t task_id, Time_t curr) {
+    return task_demand(GetTaskRemainingInstructions(task_id), GetTaskTotalInstructions(task_id), GetTaskTargetCompletion(task_id), curr);
+}
 
-    double eff_mips = remaining_instr / time_frame;
+/*
+Gets the total utilization of a vm
+*/
+double task_utilization(TaskId_t task_id, MachineId_t machine_id, Time_t curr) {
+    double eff_mips = task_mips(task_id, curr);
 
-    MachineInfo_t machine_info = Machine_GetInfo(machine_id);
-    double actual_mips = machine_info.performance[machine_info.p_state] * machine_info.num_cpus;
+    const MachineSpec_t & machine = Machine_GetSpec(machine_id);
+    MachineStatus_t machine_state = Machine_GetStatus(machine_id);
+    double actual_mips = machine.performance[machine_state.p_state] * machine.num_cpus;
     
 	return eff_mips / actual_mips;
 }
 
-// assumes one task per vm
-double vm_utilization(VMId_t vm_id, MachineId_t machine_id, Time_t curr) {
-    double utilization = 0.0;
+// booked utilization of a vm if it ran on machine_id
+double Scheduler::vm_utilization(VMId_t vm_id, MachineId_t machine_id, Time_t curr) {
+    const MachineSpec_t & machine = Machine_GetSpec(machine_id);
+    MachineStatus_t machine_state = Machine_GetStatus(machine_id);
+    double actual_mips = machine.performance[machine_state.p_state] * machine.num_cpus;
 
-    for(int i = 0; i < VM_GetInfo(vm_id).active_tasks.size(); i++) {
-        utilization += task_utilization(VM_GetInfo(vm_id).active_tasks[i], machine_id, curr);
-    }
-    
-    return utilization;
+    return ledger.VMDemand(vm_id) / actual_mips;
 }
 
 /*
-Gets the total utilization of a machine
+Gets the total booked utilization of a machine
 */
-double machine_utilization(MachineId_t machine_id, Time_t curr) {
-	double eff_mips = 0.0;
-
-    for (VMId_t vm_id : machine_matrix[machine_id]) {
-        for (TaskId_t task_id : VM_GetInfo(vm_id).active_tasks) {
-            TaskInfo_t info = GetTaskInfo(task_id);
-
-            double remaining_instr = (double) info.remaining_instructions;
-            double time_frame = (double) info.target_completion - curr;
+double Scheduler::machine_utilization(MachineId_t machine_id, Time_t curr) {
+	double eff_mips = ledger.MachineDemand(machine_id);
 
-            eff_mips += remaining_instr / time_frame;
-        }
-    }
-
-    MachineInfo_t machine_info = Machine_GetInfo(machine_id);
-    double actual_mips = machine_info.performance[machine_info.p_state] * machine_info.num_cpus;
+    const MachineSpec_t & machine = Machine_GetSpec(machine_id);
+    MachineStatus_t machine_state = Machine_GetStatus(machine_id);
+    double actual_mips = machine.performance[machine_state.p_state] * machine.num_cpus;
     
 	return eff_mips / actual_mips;
 }
 
-/*
-compares the utilization of two machines
-*/
-bool util_comp(MachineId_t a, MachineId_t b) {
-	double util_a = machine_utilization(a, Now());
-	double util_b = machine_utilization(b, Now());
-	return util_a < util_b;
-}
-
 // convert sla to prio
 Priority_t sla_to_prio(SLAType_t sla) {
     if (sla == SLA0 || sla == SLA1 || sla == SLA2) {
@@ -129,7 +218,6 @@ Priority_t sla_to_prio(SLAType_t sla) {
     return LOW_PRIORITY;
 }
 
-
 void Scheduler::Init() {
     // Find the parameters of the clusters
     // Get the total number of machines
@@ -139,10 +227,13 @@ void Scheduler::Init() {
     //      Get the number of CPUs
     //      Get if there is a GPU or not
     // 
-    SimOutput("Scheduler::Init(): Total number of machines is " + to_string(Machine_GetTotal()), 3);
-    SimOutput("Scheduler::Init(): Initializing scheduler", 1);
+    SIM_LOG(3, "Scheduler::Init(): Total number of machines is ", Machine_GetTotal());
+    SIM_LOG(1, "Scheduler::Init(): Initializing scheduler");
     total_machines = Machine_GetTotal();
+    ledger.Init(total_machines, task_demand);
     eff_list = {};
+    machine_classes = {};
+    class_of = {};
     for (int i = 0; i < total_machines; ++i) {
         if(i % 2 == 0) {
             Machine_SetState(i, S1);
@@ -150,30 +241,42 @@ void Scheduler::Init() {
             state_changing_machines[i] = info;
         }
         eff_list.push_back(i);
+        class_of.push_back(classify_machine(i));
         vector<VMId_t> temp = {};
         machine_matrix.push_back(temp);
     }
-    sort(eff_list.begin(), eff_list.end(), efficiency_comparator);    
+    sort(eff_list.begin(), eff_list.end(), [this](MachineId_t a, MachineId_t b) { return efficiency_comparator(a, b); });    
+
+    eff_by_cpu.assign(4, {});
+    eff_rank.assign(total_machines, 0);
+    empty_ranks.clear();
+    for (unsigned i = 0; i < eff_list.size(); i++) {
+        eff_by_cpu[Machine_GetSpec(eff_list[i]).cpu].push_back(eff_list[i]);
+        eff_rank[eff_list[i]] = i;
+        empty_ranks.insert(i);
+    }
 }
 
 void Scheduler::MigrationComplete(Time_t time, VMId_t vm_id) {
-    MachineId_t machine_id = VM_GetInfo(vm_id).machine_id;
     migrating_vms.erase(vm_id);
 }
 
 void Scheduler::NewTask(Time_t now, TaskId_t task_id) {
-    TaskInfo_t task_info = GetTaskInfo(task_id);
+    rebook(now);
+    TaskRequirements_t task_info = GetTaskRequirements(task_id);
     bool found = false;
-    for(MachineId_t id : eff_list) {
-        MachineInfo_t curr_machine = Machine_GetInfo(id);
+    for(MachineId_t id : eff_by_cpu[task_info.required_cpu]) {
+        const MachineSpec_t & curr_machine = Machine_GetSpec(id);
+        MachineStatus_t curr_machine_state = Machine_GetStatus(id);
         double task_util = task_utilization(task_id, id, now);
-        if(curr_machine.cpu == task_info.required_cpu && 
-            task_util + machine_utilization(id, now) < 1.0 && 
-            curr_machine.memory_used + task_info.required_memory + 8 < curr_machine.memory_size &&
-            curr_machine.s_state == S0 && !state_changing_machines_contains(id)) {                
+        if(task_util + machine_utilization(id, now) < 1.0 && 
+            curr_machine_state.memory_used + task_info.required_memory + 8 < curr_machine.memory_size &&
+            curr_machine_state.s_state == S0 && !state_changing_machines_contains(id)) {                
                 VMId_t new_vm = VM_Create(task_info.required_vm, task_info.required_cpu);
                 VM_Attach(new_vm, id);
                 VM_AddTask(new_vm, task_id, sla_to_prio(task_info.required_sla));
+                ledger.AddTask(task_id, new_vm, id, Now());
+                update_empty(id);
 
                 machine_matrix[id].push_back(new_vm);
                 task_to_vm[task_id] = new_vm;
@@ -182,27 +285,22 @@ void Scheduler::NewTask(Time_t now, TaskId_t task_id) {
             }
     }
     if(found) {
-        for(MachineId_t id : eff_list) {
-            MachineInfo_t curr_machine = Machine_GetInfo(id);
-            if(machine_utilization(id, now) == 0.0) {
-                Machine_SetState(id, S1);
-                state_changing_machines[id] = {true, 0, 0};
-                break;
-            }
-        }    
+        power_down_first_empty();
         return;
     }
 
-    for(MachineId_t id : eff_list) {
-        MachineInfo_t curr_machine = Machine_GetInfo(id);
+    for(MachineId_t id : eff_by_cpu[task_info.required_cpu]) {
+        const MachineSpec_t & curr_machine = Machine_GetSpec(id);
+        MachineStatus_t curr_machine_state = Machine_GetStatus(id);
         double task_util = task_utilization(task_id, id, now);
-        if(curr_machine.cpu == task_info.required_cpu && 
-            curr_machine.memory_used + task_info.required_memory + 8 < curr_machine.memory_size &&
+        if(curr_machine_state.memory_used + task_info.required_memory + 8 < curr_machine.memory_size &&
             !state_changing_machines_contains(id)) {    
-            if(curr_machine.s_state == S0) {
+            if(curr_machine_state.s_state == S0) {
                 VMId_t new_vm = VM_Create(task_info.required_vm, task_info.required_cpu);
                 VM_Attach(new_vm, id);
                 VM_AddTask(new_vm, task_id, sla_to_prio(task_info.required_sla));
+                ledger.AddTask(task_id, new_vm, id, Now());
+                update_empty(id);
 
                 machine_matrix[id].push_back(new_vm);
                 task_to_vm[task_id] = new_vm;
@@ -220,14 +318,7 @@ void Scheduler::NewTask(Time_t now, TaskId_t task_id) {
         queue.push_back(task_id);
     }
     else {
-        for(MachineId_t id : eff_list) {
-            MachineInfo_t curr_machine = Machine_GetInfo(id);
-            if(machine_utilization(id, now) == 0.0) {
-                Machine_SetState(id, S1);
-                state_changing_machines[id] = {true, 0, 0};
-                break;
-            }
-        }
+        power_down_first_empty();
         return;
     }
 }
@@ -237,22 +328,34 @@ void Scheduler::PeriodicCheck(Time_t now) {
     // SchedulerCheck is called periodically by the simulator to allow you to monitor, make decisions, adjustments, etc.
     // Unlike the other invocations of the scheduler, this one doesn't report any specific event
     // Recommendation: Take advantage of this function to do some monitoring and adjustments as necessary
+    rebook(now);
+#ifdef DEBUG
+    ledger.Check(now);
+    for (MachineId_t id = 0; id < eff_rank.size(); id++) {
+        if (empty_ranks.count(eff_rank[id]) != (ledger.MachineDemand(id) == 0.0)) {
+            ThrowException("Scheduler::PeriodicCheck(): Stale empty state of machine ", id);
+        }
+    }
+#endif
+
     if(now - last >= 1000000) {
         last = now;
         while(queue.size() > 0) {
             TaskId_t task_id = queue[0];
-            TaskInfo_t task_info = GetTaskInfo(task_id);
+            TaskRequirements_t task_info = GetTaskRequirements(task_id);
             bool done = false;
-            for(MachineId_t id : eff_list) {
-                MachineInfo_t curr_machine = Machine_GetInfo(id);
+            for(MachineId_t id : eff_by_cpu[task_info.required_cpu]) {
+                const MachineSpec_t & curr_machine = Machine_GetSpec(id);
+                MachineStatus_t curr_machine_state = Machine_GetStatus(id);
                 double task_util = task_utilization(task_id, id, now);
-                if(curr_machine.cpu == task_info.required_cpu && 
-                    task_util + machine_utilization(id, now) < 1.0 && 
-                    curr_machine.memory_used + task_info.required_memory + 8 < curr_machine.memory_size &&
-                    curr_machine.s_state == S0 && !state_changing_machines_contains(id)) {                
+                if(task_util + machine_utilization(id, now) < 1.0 && 
+                    curr_machine_state.memory_used + task_info.required_memory + 8 < curr_machine.memory_size &&
+                    curr_machine_state.s_state == S0 && !state_changing_machines_contains(id)) {                
                         VMId_t new_vm = VM_Create(task_info.required_vm, task_info.required_cpu);
                         VM_Attach(new_vm, id);
                         VM_AddTask(new_vm, task_id, sla_to_prio(task_info.required_sla));
+                        ledger.AddTask(task_id, new_vm, id, Now());
+                        update_empty(id);
 
                         machine_matrix[id].push_back(new_vm);
                         task_to_vm[task_id] = new_vm;
@@ -266,16 +369,18 @@ void Scheduler::PeriodicCheck(Time_t now) {
                 continue;
             }
 
-            for(MachineId_t id : eff_list) {
-                MachineInfo_t curr_machine = Machine_GetInfo(id);
+            for(MachineId_t id : eff_by_cpu[task_info.required_cpu]) {
+                const MachineSpec_t & curr_machine = Machine_GetSpec(id);
+                MachineStatus_t curr_machine_state = Machine_GetStatus(id);
                 double task_util = task_utilization(task_id, id, now);
-                if(curr_machine.cpu == task_info.required_cpu && 
-                    curr_machine.memory_used + task_info.required_memory + 8 < curr_machine.memory_size &&
+                if(curr_machine_state.memory_used + task_info.required_memory + 8 < curr_machine.memory_size &&
                     !state_changing_machines_contains(id)) {    
-                    if(curr_machine.s_state == S0) {
+                    if(curr_machine_state.s_state == S0) {
                         VMId_t new_vm = VM_Create(task_info.required_vm, task_info.required_cpu);
                         VM_Attach(new_vm, id);
                         VM_AddTask(new_vm, task_id, sla_to_prio(task_info.required_sla));
+                        ledger.AddTask(task_id, new_vm, id, Now());
+                        update_empty(id);
 
                         machine_matrix[id].push_back(new_vm);
                         task_to_vm[task_id] = new_vm;
@@ -298,6 +403,14 @@ void Scheduler::PeriodicCheck(Time_t now) {
     }
 }
 
+void Scheduler::Sample(TelemetrySample_t & sample) {
+    for (MachineId_t id = 0; id < (MachineId_t) total_machines; id++) {
+        sample.cpus[Machine_GetSpec(id).cpu].demand_mips += ledger.MachineDemand(id);
+    }
+    sample.waiting = queue.size();
+    sample.state_changes = state_changing_machines.size();
+}
+
 void Scheduler::Shutdown(Time_t time) {
     // Do your final reporting and bookkeeping here.
     // Report about the total energy consumed
@@ -306,54 +419,75 @@ void Scheduler::Shutdown(Time_t time) {
     for(auto & vm: vms) {
         VM_Shutdown(vm);
     }
-    SimOutput("SimulationComplete(): Finished!", 4);
-    SimOutput("SimulationComplete(): Time is " + to_string(time), 4);
+    SIM_LOG(4, "SimulationComplete(): Finished!");
+    SIM_LOG(4, "SimulationComplete(): Time is ", time);
 }
 
 void Scheduler::TaskComplete(Time_t now, TaskId_t task_id) {
     // Do any bookkeeping necessary for the data structures
     // Decide if a machine is to be turned off, slowed down, or VMs to be migrated according to your policy
     // This is an opportunity to make any adjustments to optimize performance/energy
+    rebook(now);
     // shutdown old vm
     VMId_t old_vm = task_to_vm[task_id];
-    MachineId_t curr_machine = VM_GetInfo(old_vm).machine_id;
+    MachineId_t booked_machine = ledger.VMMachine(old_vm);
     task_to_vm.erase(task_id);
+    ledger.RemoveTask(task_id);
+    update_empty(booked_machine);
     if(!migrating_vms.count(old_vm)) {
         VM_Shutdown(old_vm);
     }
+    // utilization of every machine in one pass, indexed by machine id
+    vector<double> demand(total_machines);
+    vector<double> capacity(total_machines);
+    vector<double> util(total_machines);
+    vector<unsigned> memory_used(total_machines);
+    for(int i = 0; i < total_machines; i++) {
+        const MachineSpec_t & machine = Machine_GetSpec(i);
+        MachineStatus_t machine_state = Machine_GetStatus(i);
+        demand[i] = ledger.MachineDemand(i);
+        capacity[i] = machine.performance[machine_state.p_state] * machine.num_cpus;
+        memory_used[i] = machine_state.memory_used;
+    }
+    Demand_Utilization(demand.data(), capacity.data(), total_machines, util.data());
+
     vector<unsigned> util_list;
     for(int i = 0; i < total_machines; i++) {
         util_list.push_back(i);
     }
 
-    sort(util_list.begin(), util_list.end(), util_comp);
+    sort(util_list.begin(), util_list.end(), [&util](MachineId_t a, MachineId_t b) { return util[a] < util[b]; });
     vector<unsigned> total_util;
     vector<unsigned> mem_usage;
     for(int i = 0; i < total_machines; i++) {
-        total_util.push_back(machine_utilization(util_list[i], now));
-        mem_usage.push_back(Machine_GetInfo(util_list[i]).memory_used);
+        total_util.push_back(util[util_list[i]]);
+        mem_usage.push_back(memory_used[util_list[i]]);
     }
 
     for(int i = 0; i < total_machines / 2; i++) {
         MachineId_t curr_machine_id = util_list[i];
-        MachineInfo_t curr_machine = Machine_GetInfo(curr_machine_id); 
         for(int j = 0; j < machine_matrix[curr_machine_id].size(); j++) {
             VMId_t vm_id = machine_matrix[curr_machine_id][j];
             if(!migrating_vms.count(vm_id)) {
                 TaskId_t task_id = 0;
-                TaskInfo_t task_info;
-                if(VM_GetInfo(vm_id).active_tasks.size() > 0) {
-                    task_id = VM_GetInfo(vm_id).active_tasks[0];
-                    task_info = GetTaskInfo(task_id);
+                TaskRequirements_t task_info;
+                TaskList_t vm_tasks = VM_GetTasks(vm_id);
+                if(vm_tasks.size() > 0) {
+                    task_id = vm_tasks[0];
+                    task_info = GetTaskRequirements(task_id);
                     for(int k = total_machines - 1; k > total_machines / 2; k--) {
                         double vm_util = vm_utilization(vm_id, util_list[k], now);
-                        MachineInfo_t new_machine = Machine_GetInfo((MachineId_t) util_list[k]);
-                        if(new_machine.s_state == S0 && new_machine.cpu == task_info.required_cpu && 
+                        const MachineSpec_t & new_machine = Machine_GetSpec((MachineId_t) util_list[k]);
+                        MachineStatus_t new_machine_state = Machine_GetStatus((MachineId_t) util_list[k]);
+                        if(new_machine_state.s_state == S0 && new_machine.cpu == task_info.required_cpu && 
                             vm_util + total_util[k] < 1.0 && 
                             mem_usage[k] + task_info.required_memory + 8 < new_machine.memory_size) {
                             total_util[k] += vm_util;
                             mem_usage[k] += task_info.required_memory + 8;
                             VM_Migrate(vm_id, (MachineId_t) util_list[k]);
+                            ledger.MoveVM(vm_id, (MachineId_t) util_list[k]);
+                            update_empty(curr_machine_id);
+                            update_empty(util_list[k]);
                             machine_matrix[curr_machine_id].erase(remove(machine_matrix[curr_machine_id].begin(), 
                                 machine_matrix[curr_machine_id].end(), vm_id), machine_matrix[curr_machine_id].end());
                             machine_matrix[(MachineId_t) util_list[k]].push_back(vm_id);
@@ -365,75 +499,25 @@ void Scheduler::TaskComplete(Time_t now, TaskId_t task_id) {
             }
         }   
     }
-    SimOutput("Scheduler::TaskComplete(): Task " + to_string(task_id) + " is complete at " + to_string(now), 4);
-}
-
-// Public interface below
-
-static Scheduler Scheduler;
-
-void InitScheduler() {
-    SimOutput("InitScheduler(): Initializing scheduler", 4);
-    Scheduler.Init();
-}
-
-void HandleNewTask(Time_t time, TaskId_t task_id) {
-    SimOutput("HandleNewTask(): Received new task " + to_string(task_id) + " at time " + to_string(time), 4);
-    Scheduler.NewTask(time, task_id);
-}
-
-void HandleTaskCompletion(Time_t time, TaskId_t task_id) {
-    SimOutput("HandleTaskCompletion(): Task " + to_string(task_id) + " completed at time " + to_string(time), 4);
-    Scheduler.TaskComplete(time, task_id);
-}
-
-void MemoryWarning(Time_t time, MachineId_t machine_id) {
-    // The simulator is alerting you that machine identified by machine_id is overcommitted
-    SimOutput("MemoryWarning(): Overflow at " + to_string(machine_id) + " was detected at time " + to_string(time), 0);
-}
-
-void MigrationDone(Time_t time, VMId_t vm_id) {
-    // The function is called on to alert you that migration is complete
-    SimOutput("MigrationDone(): Migration of VM " + to_string(vm_id) + " was completed at time " + to_string(time), 4);
-    Scheduler.MigrationComplete(time, vm_id);
+    SIM_LOG(4, "Scheduler::TaskComplete(): Task ", task_id, " is complete at ", now);
 }
 
-void SchedulerCheck(Time_t time) {
-    // This function is called periodically by the simulator, no specific event
-    // printf("scheduler check called\n");
-    SimOutput("SchedulerCheck(): SchedulerCheck() called at " + to_string(time), 4);
-    Scheduler.PeriodicCheck(time);
-}
-
-void SimulationComplete(Time_t time) {
-    // This function is called before the simulation terminates Add whatever you feel like.
-    cout << "SLA violation report" << endl;
-    cout << "SLA0: " << GetSLAReport(SLA0) << "%" << endl;
-    cout << "SLA1: " << GetSLAReport(SLA1) << "%" << endl;
-    cout << "SLA2: " << GetSLAReport(SLA2) << "%" << endl;     // SLA3 do not have SLA violation issues
-    cout << "Total Energy " << Machine_GetClusterEnergy() << "KW-Hour" << endl;
-    cout << "Simulation run finished in " << double(time)/1000000 << " seconds" << endl;
-    SimOutput("SimulationComplete(): Simulation finished at time " + to_string(time), 4);
-    
-    Scheduler.Shutdown(time);
-}
-
-void SLAWarning(Time_t time, TaskId_t task_id) {
-}
-
-void StateChangeComplete(Time_t time, MachineId_t machine_id) {
+void Scheduler::StateChangeComplete(Time_t time, MachineId_t machine_id) {
     // Called in response to an earlier request to change the state of a machine
-    MachineInfo_t machine_info = Machine_GetInfo(machine_id);
+    rebook(time);
+    MachineStatus_t machine_info = Machine_GetStatus(machine_id);
     
     if (machine_info.s_state == S0) {
         state_change_info info = state_changing_machines[machine_id];
         // for assigning tasks to inactive machine once woken
         // new task
         if (info.for_new_task) {
-            TaskInfo_t task_info = GetTaskInfo(info.new_task_id);
+            TaskRequirements_t task_info = GetTaskRequirements(info.new_task_id);
             VMId_t new_vm = VM_Create(task_info.required_vm, task_info.required_cpu);
             VM_Attach(new_vm, machine_id);
             VM_AddTask(new_vm, info.new_task_id, sla_to_prio(task_info.required_sla));
+            ledger.AddTask(info.new_task_id, new_vm, machine_id, Now());
+            update_empty(machine_id);
             machine_matrix[machine_id].push_back(new_vm);
             task_to_vm[info.new_task_id] = new_vm;
         } 
@@ -441,4 +525,10 @@ void StateChangeComplete(Time_t time, MachineId_t machine_id) {
     state_changing_machines.erase(machine_id);
 }
 
+SchedulerPolicy * Create() {
+    return new Scheduler();
+}
+
+static bool registered = Scheduler_Register("pmapper", Create);
 
+} // namespace pmapper_policy
@@ -43,6 +43,7 @@ typedef enum {
     RISCV,
     X86
 } CPUType_t;
+#define NUM_CPU_TYPES 4
 
 typedef enum {
     S0,         // Machine is up. CPU's are at state C0 if running a task or C1
@@ -84,6 +85,7 @@ typedef enum {
     WIN,
     AIX
 } VMType_t;
+#define NUM_VM_TYPES 4
 #define VM_MEMORY_OVERHEAD  8 
 
 typedef struct {
@@ -104,6 +106,28 @@ typedef struct {
     MachineId_t machine_id;                 // The identifier of the machine
 } MachineInfo_t;
 
+// MachineInfo_t split into the part that is fixed once the machine is added and the part that changes as it runs
+typedef struct {
+    unsigned num_cpus;                      // Number of CPU's on the machine
+    CPUType_t cpu;                          // CPU types deployed in the machine
+    unsigned memory_size;                   // Size of memory
+    bool gpus;                              // True if the processors are equipped with a GPU, false otherwise
+    vector<unsigned> performance;           // The MIPS ratings for the CPUs at different p-state
+    vector<unsigned> c_states;              // Power consumption under different C states
+    vector<unsigned> p_states;              // Power consumption for cores at different P states. Valid only when C-state is C0.
+    vector<unsigned> s_states;              // Machine power consumption under different S states
+    MachineId_t machine_id;                 // The identifier of the machine
+} MachineSpec_t;
+
+typedef struct {
+    unsigned memory_used;                   // The memory currently in use
+    unsigned active_tasks;                  // Number of tasks that are assigned to this machine
+    unsigned active_vms;                    // Number of virtual machines that are attached to this machine
+    uint64_t energy_consumed;               // How much energy has been consumed so far
+    MachineState_t s_state;                 // The current S state of the machine
+    CPUPerformance_t p_state;               // The current P state of the CPUs
+} MachineStatus_t;
+
 typedef struct {
     bool completed;
 
@@ -124,6 +148,16 @@ typedef struct {
     TaskId_t task_id;
 } TaskInfo_t;
 
+// The placement constraints of a task, packed into 8 bytes instead of the
+// whole TaskInfo_t
+typedef struct {
+    unsigned required_memory;
+    CPUType_t required_cpu : 2;
+    VMType_t required_vm : 2;
+    SLAType_t required_sla : 2;
+    bool gpu_capable : 1;
+} TaskRequirements_t;
+
 typedef struct {
     vector<TaskId_t> active_tasks;
     CPUType_t cpu;
@@ -132,4 +166,17 @@ typedef struct {
     VMType_t vm_type;
 } VMInfo_t;
 
+// Read-only view of a list of tasks owned by the simulator. It stays valid until
+// the next call that returns a view of the same list.
+typedef struct TaskList_t {
+    const TaskId_t * first;
+    size_t count;
+
+    const TaskId_t * begin() const              { return first; }
+    const TaskId_t * end() const                { return first + count; }
+    bool empty() const                          { return count == 0; }
+    size_t size() const                         { return count; }
+    TaskId_t operator[](size_t i) const         { return first[i]; }
+} TaskList_t;
+
 #endif /* SimTypes_h */
\ No newline at end of file
@@ -0,0 +1,68 @@
+//
+//  TaskView.cpp
+//  CloudSim
+//
+//  Field getters for tasks, so that the scheduler does not have to copy a whole
+//  TaskInfo_t to read one number. Everything but the remaining instructions is
+//  fixed when the task is added, so it is copied out once into parallel arrays
+//  indexed by task id: the instruction count and target completion that the
+//  demand computations read on every placement, and the packed requirements
+//  that placement reads once per task. The remaining instructions come straight
+//  from the task module. TaskView_Reset() drops the copies, so that a new run
+//  starts from the tasks of its own input.
+//
+
+#include "Interfaces.h"
+#include "Internal_Interfaces.h"
+
+static vector<uint64_t> TotalInstructions;
+static vector<Time_t> TargetCompletions;
+static vector<TaskRequirements_t> Requirements;
+
+// Copies out the tasks added since the last call, up to and including task_id
+static void Load(TaskId_t task_id) {
+    unsigned total = GetNumTasks();
+    if (task_id >= total) {
+        ThrowException("TaskView: Invalid task id ", task_id);
+    }
+    TotalInstructions.reserve(total);
+    TargetCompletions.reserve(total);
+    Requirements.reserve(total);
+    for (TaskId_t id = TotalInstructions.size(); id < total; id++) {
+        TaskInfo_t info = GetTaskInfo(id);
+        TotalInstructions.push_back(info.total_instructions);
+        TargetCompletions.push_back(info.target_completion);
+        Requirements.push_back({info.required_memory, info.required_cpu, info.required_vm, info.required_sla, info.gpu_capable});
+    }
+}
+
+uint64_t GetTaskRemainingInstructions(TaskId_t task_id) {
+    return GetRemainingInstructions(task_id);
+}
+
+TaskRequirements_t GetTaskRequirements(TaskId_t task_id) {
+    if (task_id >= Requirements.size()) {
+        Load(task_id);
+    }
+    return Requirements[task_id];
+}
+
+Time_t GetTaskTargetCompletion(TaskId_t task_id) {
+    if (task_id >= TargetCompletions.size()) {
+        Load(task_id);
+    }
+    return TargetCompletions[task_id];
+}
+
+uint64_t GetTaskTotalInstructions(TaskId_t task_id) {
+    if (task_id >= TotalInstructions.size()) {
+        Load(task_id);
+    }
+    return TotalInstructions[task_id];
+}
+
+void TaskView_Reset() {
+    TotalInstructions.clear();
+    TargetCompletions.clear();
+    Requirements.clear();
+}
@@ -0,0 +1,103 @@
+//
+//  Telemetry.cpp
+//  CloudSim
+//
+
+#include "Telemetry.h"
+
+#include <cstdlib>
+#include <fstream>
+
+#include "Interfaces.h"
+
+static const unsigned BUFFER_SAMPLES = 4096;
+static const char * CPU_NAMES[NUM_CPU_TYPES] = {"arm", "power", "riscv", "x86"};
+static const Time_t DEFAULT_INTERVAL = 1000000;
+
+Time_t Telemetry_Next = Time_t(-1);
+
+static Time_t interval = DEFAULT_INTERVAL;
+static vector<TelemetrySample_t> buffer;
+static size_t used = 0;
+static ofstream out;
+static Time_t last_time = 0;
+static double last_energy = 0.0;
+
+TelemetrySample_t & Telemetry_Begin(Time_t time) {
+    if (used == buffer.size()) {
+        Telemetry_Flush();
+    }
+    TelemetrySample_t & sample = buffer[used++];
+    sample = {};
+    sample.time = time;
+
+    double energy = Machine_GetClusterEnergy();
+    if (time > last_time) {
+        sample.power_kw = (energy - last_energy) / (double(time - last_time) / 3600000000.0);
+    }
+    last_energy = energy;
+    last_time = time;
+
+    unsigned total = Machine_GetTotal();
+    for (MachineId_t id = 0; id < total; id++) {
+        const MachineSpec_t & spec = Machine_GetSpec(id);
+        MachineStatus_t status = Machine_GetStatus(id);
+        TelemetryCPU_t & cpu = sample.cpus[spec.cpu];
+        if (status.s_state != S0) {
+            cpu.off++;
+            continue;
+        }
+        if (status.active_tasks > 0) {
+            cpu.running++;
+        } else {
+            cpu.idle++;
+        }
+        cpu.available_mips += double(spec.performance[status.p_state]) * spec.num_cpus;
+    }
+
+    Telemetry_Next = time - time % interval + interval;
+    return sample;
+}
+
+void Telemetry_Flush() {
+    for (size_t i = 0; i < used; i++) {
+        const TelemetrySample_t & sample = buffer[i];
+        out << double(sample.time) / 1000000 << "," << sample.power_kw << "," << sample.waiting << "," << sample.state_changes;
+        for (const TelemetryCPU_t & cpu : sample.cpus) {
+            out << "," << cpu.running << "," << cpu.idle << "," << cpu.off << "," << cpu.demand_mips << "," << cpu.available_mips;
+        }
+        out << "\n";
+    }
+    out.flush();
+    used = 0;
+}
+
+void Telemetry_Init() {
+    Telemetry_Next = Time_t(-1);
+    if (out.is_open()) {
+        out.close();
+    }
+    interval = DEFAULT_INTERVAL;
+    used = 0;
+    const char * file = getenv("SIM_TELEMETRY");
+    if (file == nullptr || *file == '\0') {
+        return;
+    }
+    const char * setting = getenv("SIM_TELEMETRY_INTERVAL");
+    if (setting != nullptr && strtoull(setting, nullptr, 10) > 0) {
+        interval = strtoull(setting, nullptr, 10);
+    }
+    out.open(file);
+    if (!out) {
+        ThrowException("Telemetry_Init(): Cannot open ", file);
+    }
+    out << "time_s,power_kw,waiting,state_changes";
+    for (const char * name : CPU_NAMES) {
+        out << "," << name << "_running," << name << "_idle," << name << "_off," << name << "_demand_mips," << name << "_available_mips";
+    }
+    out << "\n";
+    buffer.resize(BUFFER_SAMPLES);
+    last_time = 0;
+    last_energy = 0.0;
+    Telemetry_Next = 0;
+}
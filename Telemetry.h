@@ -0,0 +1,48 @@
+//
+//  Telemetry.h
+//  CloudSim
+//
+//  Time series of the cluster state, written as CSV. Set SIM_TELEMETRY=<file>
+//  to enable it and SIM_TELEMETRY_INTERVAL=<microseconds> to change the
+//  simulated sampling interval (1 s by default). Samples are taken from
+//  SchedulerCheck(), so the interval cannot be finer than the simulator's
+//  check period. They go into a preallocated buffer that is written out only
+//  when it fills up and at the end of the run.
+//
+//  Machines are counted as running (S0 with tasks), idle (S0 without tasks) or
+//  off (any other S-state). Power is the mean over the interval since the last
+//  sample. The policy fills in the demand, queue and state change figures.
+//
+
+#ifndef Telemetry_h
+#define Telemetry_h
+
+#include "SimTypes.h"
+
+typedef struct {
+    unsigned running;
+    unsigned idle;
+    unsigned off;
+    double demand_mips;                     // Booked by the policy
+    double available_mips;                  // S0 machines at their current P-state
+} TelemetryCPU_t;
+
+typedef struct {
+    Time_t time;
+    double power_kw;
+    unsigned waiting;                       // Tasks the policy holds back for lack of capacity
+    unsigned state_changes;                 // Machines with an S-state change in flight
+    TelemetryCPU_t cpus[NUM_CPU_TYPES];
+} TelemetrySample_t;
+
+extern Time_t           Telemetry_Next;                                 // Time of the next sample, never if disabled
+
+extern TelemetrySample_t & Telemetry_Begin(Time_t time);               // Fills in the machine figures
+extern void             Telemetry_Flush();
+extern void             Telemetry_Init();
+
+inline bool Telemetry_Due(Time_t time) {
+    return time >= Telemetry_Next;
+}
+
+#endif /* Telemetry_h */
@@ -0,0 +1,42 @@
+//
+//  VMView.cpp
+//  CloudSim
+//
+//  VM_GetTasks() and VM_GetType() on top of VM_GetInfo(). The type of a VM is
+//  fixed by VM_Create and is looked up once. The active task list still has to
+//  be pulled through VM_GetInfo() until the VM module can hand out its own
+//  list, so every VM_GetTasks() call copies the whole VMInfo_t and the task
+//  list into a per-VM buffer kept here, allocating as the VM_GetInfo() copy
+//  does. The view returned points into that buffer and is invalidated by the
+//  next VM_GetTasks() call for the same VM. VMView_Reset() empties both tables
+//  for a new run.
+//
+
+#include "Interfaces.h"
+#include "Internal_Interfaces.h"
+
+static vector<vector<TaskId_t>> Tasks;
+static vector<int> Types;                   // -1 until the type of the VM is known
+
+TaskList_t VM_GetTasks(VMId_t vm_id) {
+    if (vm_id >= Tasks.size()) {
+        Tasks.resize(vm_id + 1);
+    }
+    Tasks[vm_id] = VM_GetInfo(vm_id).active_tasks;
+    return {Tasks[vm_id].data(), Tasks[vm_id].size()};
+}
+
+VMType_t VM_GetType(VMId_t vm_id) {
+    if (vm_id >= Types.size()) {
+        Types.resize(vm_id + 1, -1);
+    }
+    if (Types[vm_id] < 0) {
+        Types[vm_id] = VM_GetInfo(vm_id).vm_type;
+    }
+    return VMType_t(Types[vm_id]);
+}
+
+void VMView_Reset() {
+    Tasks.clear();
+    Types.clear();
+}